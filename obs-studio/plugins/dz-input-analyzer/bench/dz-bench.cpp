@@ -0,0 +1,451 @@
+// plugins/dz-input-analyzer/bench/dz-bench.cpp
+//
+// Headless benchmark of the capture -> ring -> timeline -> draw list path, driven by
+// synthetic input on a simulated clock. Reports ns per raw input record, ns per frame
+// and heap allocations per frame; no OBS, GPU or Win32 needed.
+//
+// usage: dz-input-analyzer-bench [seconds]
+//
+// A few correctness checks run first; the exit code is the number that failed.
+
+#include "dz-timeline.h"
+#include "dz-drawlist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+// ------------------------------------------------------------
+// Allocation counting
+static uint64_t g_allocs = 0;
+
+void *operator new(size_t size)
+{
+	g_allocs++;
+	if (void *p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+#ifdef _WIN32
+#include <malloc.h>
+#define bench_aligned_alloc(a, size) _aligned_malloc(size, a)
+#define bench_aligned_free(p) _aligned_free(p)
+#else
+#define bench_aligned_alloc(a, size) aligned_alloc(a, size)
+#define bench_aligned_free(p) free(p)
+#endif
+
+void *operator new(size_t size, std::align_val_t align)
+{
+	g_allocs++;
+	const size_t a = (size_t)align;
+	if (void *p = bench_aligned_alloc(a, (size + a - 1) / a * a))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+	bench_aligned_free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+	bench_aligned_free(p);
+}
+
+static inline int64_t bench_ns()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ------------------------------------------------------------
+// Synthetic input
+static constexpr int64_t FRAME_US = 1000000 / 144;
+static constexpr int64_t MOUSE_US = 125;     // 8 kHz polling
+static constexpr int64_t STRAFE_US = 50000;  // 20 Hz A/D switches
+static constexpr int64_t STRAFE_GAP_US = 6000;
+static constexpr int64_t BURST_US = 1000000; // one burst per second
+static constexpr int64_t BURST_CLICK_US = 90000;
+static constexpr int BURST_CLICKS = 5;
+
+enum bench_input : unsigned {
+	BENCH_MOUSE = 1,
+	BENCH_STRAFE = 2,
+	BENCH_CLICKS = 4,
+	BENCH_ALL = 7,
+};
+
+// Feeds every raw record in [t0, t1) into the capture stage; returns the record count
+static uint64_t bench_generate(dz_capture *cap, unsigned inputs, int64_t t0, int64_t t1)
+{
+	uint64_t records = 0;
+	for (int64_t t = t0 - t0 % MOUSE_US; t < t1; t += MOUSE_US) {
+		if (t < t0)
+			continue;
+
+		if (inputs & BENCH_MOUSE) {
+			const double phase = (double)t / 400000.0;
+			dz_capture_motion(cap, t, (int)std::lround(12.0 * std::sin(phase)), (int)(t / MOUSE_US % 3) - 1);
+			records++;
+		}
+
+		if (inputs & BENCH_STRAFE) {
+			const int64_t in_cycle = t % STRAFE_US;
+			const bool left = (t / STRAFE_US) % 2 == 0;
+			if (in_cycle == 0) {
+				dz_capture_key(cap, left ? 'D' : 'A', false, t);
+				records++;
+			} else if (in_cycle == STRAFE_GAP_US) {
+				dz_capture_key(cap, left ? 'A' : 'D', true, t);
+				records++;
+			}
+		}
+
+		if (inputs & BENCH_CLICKS) {
+			const int64_t in_burst = t % BURST_US;
+			if (in_burst % BURST_CLICK_US == 12000 && in_burst / BURST_CLICK_US < BURST_CLICKS) {
+				dz_capture_click(cap, t);
+				records++;
+			}
+		}
+	}
+	return records;
+}
+
+// Same defaults as a freshly added source, with both optional lanes on
+static void bench_settings(dz_settings *s)
+{
+	s->history_capacity = dz_history_capacity(s->history_us);
+	s->show_stats = true;
+	s->show_motion = true;
+
+	const uint16_t keys[DZ_DEFAULT_ROWS] = {'W', 'S', 'A', 'D'};
+	const uint32_t colors[DZ_DEFAULT_ROWS] = {0x005dc8f3, 0x009cff9c, 0x003f3fcf, 0x00c8a00a};
+	memset(s->vkey_row, -1, sizeof(s->vkey_row));
+	for (int i = 0; i < s->row_count; i++) {
+		s->row_enabled[i] = true;
+		s->row_key_vkey[i] = keys[i];
+		s->row_label[i][0] = (char)keys[i];
+		s->vkey_row[keys[i]] = (int8_t)i;
+		s->key_color[i] = colors[i];
+		s->visible_row[s->visible_count++] = (uint8_t)i;
+	}
+}
+
+struct bench_result {
+	uint64_t frames = 0;
+	uint64_t records = 0;
+	uint64_t applied = 0;
+	int64_t ingest_ns = 0;
+	int64_t frame_ns = 0;
+	int64_t frame_p99_ns = 0;
+	int64_t gpu_fill_ns = 0; // dz_build_gpu_timeline, the shader path's per-upload work
+	uint64_t allocs = 0;
+	size_t vertices = 0;
+};
+
+static bench_result bench_run(unsigned inputs, int64_t seconds)
+{
+	dz_settings cfg;
+	bench_settings(&cfg);
+
+	auto sub = std::make_unique<dz_subscriber>();
+	auto tl = std::make_unique<dz_timeline>();
+	dz_capture cap;
+	cap.subscribers.push_back(sub.get());
+	dz_timeline_init(tl.get());
+	dz_timeline_adopt(tl.get(), nullptr, &cfg, 0);
+	sub->wants_motion.store(tl->motion.capacity != 0, std::memory_order_relaxed);
+
+	dz_layout L;
+	dz_compute_layout(&cfg, &L);
+	dz_batch batch;
+	std::vector<float> texels((size_t)DZ_GPU_TEX_WIDTH * DZ_GPU_TEX_HEIGHT * 4);
+
+	const int64_t warmup_us = cfg.history_us + 1000000; // rings at their steady size
+	const int64_t end_us = warmup_us + seconds * 1000000;
+
+	bench_result r;
+	std::vector<int64_t> frame_times;
+	frame_times.reserve((size_t)(seconds * 1000000 / FRAME_US + 2));
+
+	uint64_t allocs_start = 0;
+	int64_t t_prev = 0;
+	for (int64_t t = FRAME_US; t < end_us; t += FRAME_US) {
+		const bool measured = t > warmup_us;
+		if (measured && !r.frames)
+			allocs_start = g_allocs;
+
+		// Capture thread work, then the render thread's drain
+		const int64_t a = bench_ns();
+		const uint64_t records = bench_generate(&cap, inputs, t_prev, t);
+		dz_capture_flush_motion(&cap);
+		uint64_t applied = 0;
+		dz_input_event ev;
+		while (sub->events.pop(ev)) {
+			dz_timeline_apply(tl.get(), &cfg, ev, nullptr);
+			applied++;
+		}
+
+		// Render thread frame: everything dz_source_render does on the CPU
+		const int64_t b = bench_ns();
+		dz_batch_clear(&batch);
+		dz_build_timeline(&cfg, tl.get(), L, t, &batch);
+		dz_build_motion_lane(&cfg, tl.get(), L, t, &batch);
+		dz_build_stats_strip(&cfg, tl.get(), L, &batch);
+		dz_timeline_cleanup(tl.get(), &cfg, t);
+		const int64_t c = bench_ns();
+		int64_t later_us;
+		dz_build_gpu_timeline(&cfg, tl.get(), L, t, t, texels.data(), (size_t)DZ_GPU_TEX_WIDTH * 4, &later_us);
+		const int64_t e = bench_ns();
+
+		if (measured) {
+			r.frames++;
+			r.records += records;
+			r.applied += applied;
+			r.ingest_ns += b - a;
+			r.frame_ns += c - b;
+			r.gpu_fill_ns += e - c;
+			r.vertices = std::max(r.vertices, batch.points.size());
+			frame_times.push_back(c - b);
+		}
+		t_prev = t;
+	}
+	r.allocs = g_allocs - allocs_start;
+
+	if (!frame_times.empty()) {
+		const size_t k = std::min(frame_times.size() - 1, (size_t)std::ceil(0.99 * frame_times.size()) - 1);
+		std::nth_element(frame_times.begin(), frame_times.begin() + k, frame_times.end());
+		r.frame_p99_ns = frame_times[k];
+	}
+	if (sub->dropped_events.load())
+		printf("  warning: %u events dropped\n", sub->dropped_events.load());
+	return r;
+}
+
+// ------------------------------------------------------------
+// Checks
+static int g_failures = 0;
+
+static void bench_expect(bool ok, const char *what)
+{
+	printf("check %-56s %s\n", what, ok ? "ok" : "FAILED");
+	g_failures += ok ? 0 : 1;
+}
+
+static dz_input_event bench_event(dz_event_type type, int64_t t, uint16_t vkey = 0)
+{
+	dz_input_event ev;
+	ev.time_us = t;
+	ev.type = type;
+	ev.vkey = vkey;
+	return ev;
+}
+
+// A slow counter-strafe: its percentiles must land on the sample, not the histogram's edge
+static void bench_check_strafe_range()
+{
+	dz_settings cfg;
+	bench_settings(&cfg);
+	auto tl = std::make_unique<dz_timeline>();
+	dz_timeline_init(tl.get());
+	dz_timeline_adopt(tl.get(), nullptr, &cfg, 0);
+
+	const int64_t t = 10000000;
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_DOWN, t, 'A'), nullptr);
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_UP, t + 100000, 'A'), nullptr);
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_DOWN, t + 250000, 'D'), nullptr);
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_CLICK, t + 950000), nullptr);
+
+	const dz_stat &gap = tl->strafe.gap;
+	const dz_stat &shot = tl->strafe.shot;
+	bench_expect(gap.samples.size() == 1 && std::fabs(gap.percentile_ms(0.5) - 150.0) < 1.0 &&
+			     std::fabs(gap.percentile_ms(0.99) - 150.0) < 1.0,
+		     "150 ms gap percentiles");
+	bench_expect(shot.samples.size() == 1 && std::fabs(shot.percentile_ms(0.5) - 700.0) < 2.0 &&
+			     std::fabs(shot.percentile_ms(0.99) - 700.0) < 2.0,
+		     "700 ms shot percentiles");
+}
+
+// Motion, a key, then more motion in the same millisecond: one subscriber's stream never
+// goes back in time
+static void bench_check_capture_order()
+{
+	auto sub = std::make_unique<dz_subscriber>();
+	sub->wants_motion.store(true, std::memory_order_relaxed);
+	dz_capture cap;
+	cap.subscribers.push_back(sub.get());
+
+	dz_capture_motion(&cap, 5100, 3, 0);
+	dz_capture_key(&cap, 'A', true, 5300);
+	dz_capture_motion(&cap, 5600, 2, 1);
+	dz_capture_click(&cap, 5800);
+	dz_capture_motion(&cap, 5900, 1, 1);
+	dz_capture_flush_motion(&cap);
+
+	bool ordered = true;
+	int64_t last_us = INT64_MIN;
+	uint32_t n = 0;
+	dz_input_event ev;
+	while (sub->events.pop(ev)) {
+		ordered &= ev.time_us >= last_us;
+		last_us = ev.time_us;
+		n++;
+	}
+	bench_expect(ordered && n == 5, "capture stream non-decreasing across a key");
+}
+
+// A press stamped after the frame time: neither path draws it yet, and the event texture
+// asks for a refill once the frame time gets there
+static void bench_check_gpu_future()
+{
+	dz_settings cfg;
+	bench_settings(&cfg);
+	auto tl = std::make_unique<dz_timeline>();
+	dz_timeline_init(tl.get());
+	dz_timeline_adopt(tl.get(), nullptr, &cfg, 0);
+	dz_layout L;
+	dz_compute_layout(&cfg, &L);
+
+	const int64_t t = 10000000;
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_DOWN, t - 2000, 'A'), nullptr);
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_UP, t - 1000, 'A'), nullptr);
+	dz_timeline_apply(tl.get(), &cfg, bench_event(DZ_EVENT_KEY_DOWN, t + 3000, 'A'), nullptr);
+
+	dz_batch batch;
+	dz_build_timeline(&cfg, tl.get(), L, t, &batch);
+	std::vector<float> texels((size_t)DZ_GPU_TEX_WIDTH * DZ_GPU_TEX_HEIGHT * 4);
+	int64_t later_us = 0;
+	dz_build_gpu_timeline(&cfg, tl.get(), L, t, t, texels.data(), (size_t)DZ_GPU_TEX_WIDTH * 4, &later_us);
+
+	uint32_t gpu_segs = 0;
+	for (int v = 0; v < L.visible_rows; v++)
+		gpu_segs += (uint32_t)texels[(size_t)v * DZ_GPU_TEX_WIDTH * 4 + 2];
+	bench_expect(gpu_segs == batch.points.size() / 6 && gpu_segs == 1 && later_us == t + 3000,
+		     "shader timeline leaves out segments after tNow");
+}
+
+static void bench_checks()
+{
+	bench_check_strafe_range();
+	bench_check_capture_order();
+	bench_check_gpu_future();
+}
+
+// Segment x mapping on its own: one full history of short presses, all inside a 60 s
+// window on a 4K wide timeline, through the build's kernel and the scalar fallback
+static void bench_x_map()
+{
+	const uint32_t n = DZ_MAX_HISTORY_CAPACITY;
+	const int64_t window_us = 60000000;
+	const int64_t base_us = 1000000000000ll; // QPC us after ~12 days of uptime
+	std::vector<dz_key_segment> segs(n);
+	for (uint32_t i = 0; i < n; i++) {
+		segs[i].start_us = base_us + (int64_t)i * window_us / n;
+		segs[i].end_us = segs[i].start_us + 700 + i % 900;
+	}
+	segs[n - 1].end_us = -1;
+
+	dz_layout L;
+	L.timelineX0 = 12.0f;
+	L.timelineX1 = 3828.0f;
+	L.timelineW = L.timelineX1 - L.timelineX0;
+	const int64_t t_now = base_us + window_us - 1000;
+	const dz_x_map m = dz_make_x_map(L, t_now - window_us, t_now, t_now);
+
+	std::vector<float> x(n), w(n), xr(n), wr(n);
+	const int reps = 200;
+	int64_t kernel_ns = INT64_MAX, scalar_ns = INT64_MAX;
+	for (int r = 0; r < reps; r++) {
+		int64_t a = bench_ns();
+		dz_map_segments(m, segs.data(), n, x.data(), w.data());
+		kernel_ns = std::min(kernel_ns, bench_ns() - a);
+		a = bench_ns();
+		dz_map_segments_scalar(m, segs.data(), n, xr.data(), wr.data());
+		scalar_ns = std::min(scalar_ns, bench_ns() - a);
+	}
+
+	const bool same = memcmp(x.data(), xr.data(), n * sizeof(float)) == 0 &&
+			  memcmp(w.data(), wr.data(), n * sizeof(float)) == 0;
+	printf("x map, %u segments: %s %.2f ns/segment, scalar %.2f ns/segment%s\n", n, dz_map_segments_isa,
+	       (double)kernel_ns / n, (double)scalar_ns / n, same ? "" : " (MISMATCH)");
+}
+
+int main(int argc, char **argv)
+{
+	const int64_t seconds = argc > 1 ? std::max(1, atoi(argv[1])) : 60;
+
+	// Static layer geometry is only rebuilt on settings changes; timed once for reference
+	{
+		dz_settings cfg;
+		bench_settings(&cfg);
+		dz_layout L;
+		dz_compute_layout(&cfg, &L);
+		dz_batch batch;
+		const int64_t a = bench_ns();
+		dz_build_static_layer(&cfg, L, &batch);
+		printf("static layer: %.1f us, %zu vertices\n", (double)(bench_ns() - a) / 1000.0,
+		       batch.points.size());
+	}
+
+	bench_checks();
+	bench_x_map();
+
+	static const struct {
+		const char *name;
+		unsigned inputs;
+	} scenarios[] = {
+		{"mouse 8khz", BENCH_MOUSE},
+		{"strafe 20hz", BENCH_STRAFE},
+		{"click bursts", BENCH_CLICKS},
+		{"all", BENCH_ALL},
+	};
+
+	printf("%lld s simulated per scenario at 144 fps, after one retention window of warm-up\n",
+	       (long long)seconds);
+	printf("%-14s %12s %12s %12s %12s %12s %10s %12s\n", "scenario", "records", "ns/event", "ns/frame",
+	       "p99 ns/frame", "allocs/frame", "vertices", "gpu fill ns");
+	for (const auto &sc : scenarios) {
+		const bench_result r = bench_run(sc.inputs, seconds);
+		printf("%-14s %12llu %12.1f %12.1f %12lld %12.3f %10zu %12.1f\n", sc.name,
+		       (unsigned long long)r.records, r.records ? (double)r.ingest_ns / (double)r.records : 0.0,
+		       r.frames ? (double)r.frame_ns / (double)r.frames : 0.0, (long long)r.frame_p99_ns,
+		       r.frames ? (double)r.allocs / (double)r.frames : 0.0, r.vertices,
+		       r.frames ? (double)r.gpu_fill_ns / (double)r.frames : 0.0);
+	}
+	return g_failures;
+}
@@ -0,0 +1,706 @@
+// plugins/dz-input-analyzer/dz-drawlist.cpp
+#include "dz-drawlist.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DZ_XMAP_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DZ_XMAP_SSE2 1
+#endif
+
+// ------------------------------------------------------------
+// Text
+
+// Minimal bitmap font (5x7) for letters and numbers.
+// Each glyph packs its 7 rows into one word, one byte per row (row 0 in the low byte),
+// 5 bits per row with the MSB on the left.
+constexpr uint64_t dz_pack_glyph(uint8_t r0, uint8_t r1, uint8_t r2, uint8_t r3, uint8_t r4, uint8_t r5, uint8_t r6)
+{
+	return (uint64_t)r0 | ((uint64_t)r1 << 8) | ((uint64_t)r2 << 16) | ((uint64_t)r3 << 24) |
+	       ((uint64_t)r4 << 32) | ((uint64_t)r5 << 40) | ((uint64_t)r6 << 48);
+}
+
+struct dz_font_5x7 {
+	uint64_t rows[128];
+};
+
+constexpr dz_font_5x7 dz_make_font()
+{
+	dz_font_5x7 t{};
+	t.rows['A'] = dz_pack_glyph(0b00100, 0b01010, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001);
+	t.rows['B'] = dz_pack_glyph(0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110);
+	t.rows['C'] = dz_pack_glyph(0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110);
+	t.rows['D'] = dz_pack_glyph(0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110);
+	t.rows['E'] = dz_pack_glyph(0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111);
+	t.rows['F'] = dz_pack_glyph(0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000);
+	t.rows['G'] = dz_pack_glyph(0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01110);
+	t.rows['H'] = dz_pack_glyph(0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001);
+	t.rows['I'] = dz_pack_glyph(0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110);
+	t.rows['J'] = dz_pack_glyph(0b00111, 0b00010, 0b00010, 0b00010, 0b10010, 0b10010, 0b01100);
+	t.rows['K'] = dz_pack_glyph(0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001);
+	t.rows['L'] = dz_pack_glyph(0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111);
+	t.rows['M'] = dz_pack_glyph(0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001);
+	t.rows['N'] = dz_pack_glyph(0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001, 0b10001);
+	t.rows['O'] = dz_pack_glyph(0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110);
+	t.rows['P'] = dz_pack_glyph(0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000);
+	t.rows['Q'] = dz_pack_glyph(0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101);
+	t.rows['R'] = dz_pack_glyph(0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001);
+	t.rows['S'] = dz_pack_glyph(0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110);
+	t.rows['T'] = dz_pack_glyph(0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100);
+	t.rows['U'] = dz_pack_glyph(0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110);
+	t.rows['V'] = dz_pack_glyph(0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100);
+	t.rows['W'] = dz_pack_glyph(0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010);
+	t.rows['X'] = dz_pack_glyph(0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001);
+	t.rows['Y'] = dz_pack_glyph(0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100);
+	t.rows['Z'] = dz_pack_glyph(0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111);
+	t.rows['0'] = dz_pack_glyph(0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110);
+	t.rows['1'] = dz_pack_glyph(0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110);
+	t.rows['2'] = dz_pack_glyph(0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111);
+	t.rows['3'] = dz_pack_glyph(0b11110, 0b00001, 0b00001, 0b01110, 0b00001, 0b00001, 0b11110);
+	t.rows['4'] = dz_pack_glyph(0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010);
+	t.rows['5'] = dz_pack_glyph(0b11111, 0b10000, 0b10000, 0b11110, 0b00001, 0b00001, 0b11110);
+	t.rows['6'] = dz_pack_glyph(0b01110, 0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110);
+	t.rows['7'] = dz_pack_glyph(0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000);
+	t.rows['8'] = dz_pack_glyph(0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110);
+	t.rows['9'] = dz_pack_glyph(0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00001, 0b01110);
+	t.rows['.'] = dz_pack_glyph(0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b01100);
+	t.rows['-'] = dz_pack_glyph(0b00000, 0b00000, 0b00000, 0b01110, 0b00000, 0b00000, 0b00000);
+	return t;
+}
+
+static constexpr dz_font_5x7 kFont5x7 = dz_make_font();
+
+static constexpr inline uint64_t glyph_5x7(char ch)
+{
+	return kFont5x7.rows[(uint8_t)ch & 0x7f];
+}
+
+// Glyph geometry pre-baked once: every glyph row is a list of horizontal pixel runs,
+// so a string costs one quad per run instead of one draw call per lit pixel.
+struct dz_glyph_run {
+	uint8_t row;
+	uint8_t col;
+	uint8_t len;
+};
+
+struct dz_glyph_atlas {
+	dz_glyph_run runs[128][7 * 3]; // at most 3 runs in a 5-bit row
+	uint8_t run_count[128];
+};
+
+static const dz_glyph_atlas &dz_glyphs()
+{
+	static const dz_glyph_atlas atlas = [] {
+		dz_glyph_atlas a{};
+		for (int ch = 0; ch < 128; ch++) {
+			uint8_t n = 0;
+			const uint64_t glyph = glyph_5x7((char)ch);
+			for (int r = 0; r < 7; r++) {
+				const uint8_t bits = (uint8_t)(glyph >> (r * 8)) & 0x1f;
+				int c = 0;
+				while (c < 5) {
+					if (!(bits & (1u << (4 - c)))) {
+						c++;
+						continue;
+					}
+					const int c0 = c;
+					while (c < 5 && (bits & (1u << (4 - c))))
+						c++;
+					a.runs[ch][n++] = {(uint8_t)r, (uint8_t)c0, (uint8_t)(c - c0)};
+				}
+			}
+			a.run_count[ch] = n;
+		}
+		return a;
+	}();
+	return atlas;
+}
+
+void dz_draw_text_5x7(dz_batch *batch, float x, float y, const char *text, float scale, const vec4 &color)
+{
+	if (!text || !*text)
+		return;
+
+	const float px = std::max(1.0f, std::floor(scale));
+	const float cell = px;
+	const uint32_t rgba = vec4_to_rgba(&color);
+	const dz_glyph_atlas &atlas = dz_glyphs();
+
+	float pen_x = x;
+	for (const char *p = text; *p; ++p) {
+		const unsigned char ch = (unsigned char)*p;
+		if (ch < 128) {
+			for (uint8_t i = 0; i < atlas.run_count[ch]; i++) {
+				const dz_glyph_run &run = atlas.runs[ch][i];
+				dz_batch_quad(batch, pen_x + run.col * cell, y + run.row * cell, run.len * cell, cell, rgba);
+			}
+		}
+		pen_x += 6.0f * cell; // 5 + 1 space
+	}
+}
+
+// ------------------------------------------------------------
+// Layout
+
+vec4 dz_row_color(const dz_settings *s, int row, float a)
+{
+	if (!s)
+		return dz_col_rgba(1.0f, 1.0f, 1.0f, a);
+
+	const int idx = std::clamp(row, 0, s->row_count - 1);
+	return dz_col_from_obs_bgr(s->key_color[idx], a);
+}
+
+// Bottom pad holds the time axis, plus the stats strip when it is shown
+float dz_bottom_pad(const dz_settings *s)
+{
+	return s->show_stats ? 75.0f : 55.0f;
+}
+
+float dz_base_row_height(const dz_settings *s)
+{
+	if (!s)
+		return 0.0f;
+
+	const float H = (float)s->height;
+	const float topPad = 18.0f;
+	const float bottomPad = dz_bottom_pad(s);
+	const float rowGap = 20.0f;
+	const float rowsAreaH = H - topPad - bottomPad;
+	const int slots = s->row_count + (s->show_motion ? 1 : 0);
+	const float rowH = (rowsAreaH - rowGap * (slots - 1)) / (float)slots;
+	return std::max(0.0f, std::floor(rowH));
+}
+
+float dz_visible_height(const dz_settings *s)
+{
+	if (!s)
+		return 0.0f;
+
+	const float topPad = 18.0f;
+	const float bottomPad = dz_bottom_pad(s);
+	const float rowGap = 20.0f;
+	const int visible_rows = s->visible_count + (s->show_motion ? 1 : 0);
+	if (visible_rows <= 0)
+		return topPad + bottomPad;
+
+	const float rowH = dz_base_row_height(s);
+	return topPad + bottomPad + visible_rows * rowH + rowGap * (visible_rows - 1);
+}
+
+// Axis tick spacing: 1s up to a 10s window, then 5s, then 10s
+static int64_t dz_tick_step_us(int64_t window_us)
+{
+	if (window_us <= 10000000)
+		return 1000000;
+	if (window_us <= 30000000)
+		return 5000000;
+	return 10000000;
+}
+
+void dz_compute_layout(const dz_settings *s, dz_layout *L)
+{
+	L->W = (float)s->width;
+	L->H = dz_visible_height(s);
+	L->bottomPad = dz_bottom_pad(s);
+
+	const float leftPad = 70.0f * 1.3f;
+	const float rightPad = 20.0f;
+
+	L->timelineX0 = leftPad;
+	L->timelineX1 = L->W - rightPad;
+	L->timelineW = L->timelineX1 - L->timelineX0;
+
+	L->rowH = dz_base_row_height(s);
+
+	L->visible_rows = s->visible_count;
+	for (int i = 0; i < DZ_MAX_ROWS; i++)
+		L->rowYs[i] = -1.0f;
+	for (int v = 0; v < L->visible_rows; v++)
+		L->rowYs[s->visible_row[v]] = L->topPad + v * (L->rowH + L->rowGap);
+	L->laneY = s->show_motion ? L->topPad + L->visible_rows * (L->rowH + L->rowGap) : -1.0f;
+
+	L->axisY = L->H - L->bottomPad + 22.0f;
+	L->axisY2 = L->axisY + 2.0f;
+}
+
+// ------------------------------------------------------------
+// Geometry
+
+// Everything that only changes with settings: background, grid, row labels and the axis
+void dz_build_static_layer(const dz_settings *s, const dz_layout &L, dz_batch *batch)
+{
+	const float W = L.W;
+	const float H = L.H;
+	const float timelineX0 = L.timelineX0;
+	const float timelineW = L.timelineW;
+
+	const int64_t WINDOW_US = s->window_us;
+	const int64_t TICK_US = dz_tick_step_us(WINDOW_US);
+
+	// Background (simple tint)
+	vec4 bg = dz_col_from_obs_bgr(s->bg_color, s->bg_alpha);
+	dz_batch_rect(batch, 0.0f, 0.0f, W, H, bg);
+
+	// Grid vertical lines at every tick (0..5s for the default window)
+	vec4 grid = dz_col_rgba(0.160784f, 0.160784f, 0.160784f, 1.0f); // #292929
+	for (int64_t tick = 0; tick <= WINDOW_US; tick += TICK_US) {
+		const float x = timelineX0 + ((float)tick / (float)WINDOW_US) * timelineW;
+		const float y0 = L.topPad - 6.0f;
+		const float h = std::max(2.0f, L.axisY2 - y0);
+		dz_batch_rect(batch, x, y0, 2.0f, h, grid);
+	}
+
+	// Row labels using bitmap font
+	if (L.visible_rows > 0) {
+		vec4 text = dz_col_rgba(1.0f, 1.0f, 1.0f, 0.92f);
+		for (int v = 0; v < L.visible_rows; v++) {
+			const int i = s->visible_row[v];
+			const char *label = s->row_label[i];
+			const size_t label_len = strlen(label);
+			float scale = 4.0f * 0.85f;
+			if (label_len > 10)
+				scale = 3.0f * 0.85f;
+			if (label_len > 16)
+				scale = 2.0f * 0.85f;
+			const float yMid = L.rowYs[i] + L.rowH * 0.5f;
+			// Center the 5x7 block vertically around yMid
+			const float glyphH = 7.0f * std::floor(scale);
+			const float y = yMid - glyphH * 0.5f;
+			dz_draw_text_5x7(batch, 22.0f, y, label, scale, text);
+		}
+	}
+
+	// Mouse lane label and zero line
+	if (L.laneY >= 0.0f) {
+		vec4 text = dz_col_rgba(1.0f, 1.0f, 1.0f, 0.92f);
+		const float scale = 4.0f * 0.85f;
+		const float glyphH = 7.0f * std::floor(scale);
+		dz_draw_text_5x7(batch, 22.0f, L.laneY + (L.rowH - glyphH) * 0.5f, "MSE", scale, text);
+
+		vec4 zero_line = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
+		dz_batch_rect(batch, timelineX0, L.laneY + L.rowH - 1.0f, timelineW, 1.0f, zero_line);
+	}
+
+	// TIME axis line + ticks + labels (0s..5s for the default window)
+	{
+		const float axisY = L.axisY;
+
+		// Axis baseline: #292929
+		vec4 axis = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
+		dz_batch_rect(batch, timelineX0, axisY, timelineW, 2.0f, axis);
+
+		// Tick/grid color: #292929 (only the vertical tick lines)
+		vec4 tick_col = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
+
+		// Tick label color (0s..5s)
+		vec4 tcol = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
+
+		for (int64_t tick = 0; tick <= WINDOW_US; tick += TICK_US) {
+			const float x = timelineX0 + ((float)tick / (float)WINDOW_US) * timelineW;
+			dz_batch_rect(batch, x, axisY, 2.0f, 12.0f, tick_col);
+
+			char lab[8]{};
+			snprintf(lab, sizeof(lab), "%dS", (int)(tick / 1000000));
+
+			dz_draw_text_5x7(batch, x - 10.0f, axisY + 10.0f, lab, 2.28f, tcol);
+		}
+	}
+}
+
+static float dz_bar_height(float rowH)
+{
+	return std::max(2.0f, std::round(rowH * 0.2975625f));
+}
+
+// Key segments, click markers and delta numbers for the window ending at tNow
+// ------------------------------------------------------------
+// Segment x mapping
+
+static inline float dz_map_x(const dz_x_map &m, int64_t t)
+{
+	if (m.denom <= 0.0)
+		return m.x0;
+	const double u = (double)(t - m.t0) / m.denom;
+	return m.x0 + (float)(u * m.width);
+}
+
+static inline float dz_clampf(float v, float a, float b)
+{
+	return std::max(a, std::min(b, v));
+}
+
+void dz_map_segments_scalar(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		const int64_t end = segs[i].end_us < 0 ? m.t_now : segs[i].end_us;
+		const float x0s = dz_clampf(dz_map_x(m, segs[i].start_us), m.x0, m.x1);
+		const float x1s = dz_clampf(dz_map_x(m, end), m.x0, m.x1);
+		x[i] = x0s;
+		w[i] = std::max(2.0f, x1s - x0s);
+	}
+}
+
+#if defined(DZ_XMAP_AVX2) || defined(DZ_XMAP_SSE2)
+// int64 -> double for |v| < 2^51 (no such conversion below AVX-512): add the integer into the
+// mantissa of 1.5 * 2^52, then subtract that back out. Exact, so the math matches the scalar path.
+static constexpr int64_t DZ_I2D_MAGIC_BITS = 0x4338000000000000ll;
+static constexpr double DZ_I2D_MAGIC = 6755399441055744.0;
+#endif
+
+#if defined(DZ_XMAP_AVX2)
+const char *const dz_map_segments_isa = "avx2";
+
+static inline __m256d dz_i64_to_pd(__m256i v)
+{
+	const __m256i bits = _mm256_add_epi64(v, _mm256_set1_epi64x(DZ_I2D_MAGIC_BITS));
+	return _mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(DZ_I2D_MAGIC));
+}
+
+void dz_map_segments(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w)
+{
+	uint32_t i = 0;
+	if (m.denom > 0.0) {
+		const __m256d t0 = _mm256_set1_pd((double)m.t0);
+		const __m256d t_now = _mm256_set1_pd((double)m.t_now);
+		const __m256d denom = _mm256_set1_pd(m.denom);
+		const __m256d width = _mm256_set1_pd(m.width);
+		const __m128 x0 = _mm_set1_ps(m.x0);
+		const __m128 x1 = _mm_set1_ps(m.x1);
+		const __m128 min_w = _mm_set1_ps(2.0f);
+
+		for (; i + 4 <= n; i += 4) {
+			// (s0 e0 s1 e1), (s2 e2 s3 e3) -> (s0 s1 s2 s3), (e0 e1 e2 e3)
+			const __m256i a = _mm256_loadu_si256((const __m256i *)(segs + i));
+			const __m256i b = _mm256_loadu_si256((const __m256i *)(segs + i + 2));
+			const __m256i si = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xD8);
+			const __m256i ei = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xD8);
+
+			const __m256d start = dz_i64_to_pd(si);
+			__m256d end = dz_i64_to_pd(ei);
+			end = _mm256_blendv_pd(end, t_now, _mm256_cmp_pd(end, _mm256_setzero_pd(), _CMP_LT_OQ));
+
+			const __m256d us = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(start, t0), denom), width);
+			const __m256d ue = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(end, t0), denom), width);
+			const __m128 xs = _mm_max_ps(x0, _mm_min_ps(x1, _mm_add_ps(x0, _mm256_cvtpd_ps(us))));
+			const __m128 xe = _mm_max_ps(x0, _mm_min_ps(x1, _mm_add_ps(x0, _mm256_cvtpd_ps(ue))));
+			_mm_storeu_ps(x + i, xs);
+			_mm_storeu_ps(w + i, _mm_max_ps(min_w, _mm_sub_ps(xe, xs)));
+		}
+	}
+	dz_map_segments_scalar(m, segs + i, n - i, x + i, w + i);
+}
+#elif defined(DZ_XMAP_SSE2)
+const char *const dz_map_segments_isa = "sse2";
+
+static inline __m128d dz_i64_to_pd(__m128i v)
+{
+	const __m128i bits = _mm_add_epi64(v, _mm_set1_epi64x(DZ_I2D_MAGIC_BITS));
+	return _mm_sub_pd(_mm_castsi128_pd(bits), _mm_set1_pd(DZ_I2D_MAGIC));
+}
+
+void dz_map_segments(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w)
+{
+	uint32_t i = 0;
+	if (m.denom > 0.0) {
+		const __m128d t0 = _mm_set1_pd((double)m.t0);
+		const __m128d t_now = _mm_set1_pd((double)m.t_now);
+		const __m128d denom = _mm_set1_pd(m.denom);
+		const __m128d width = _mm_set1_pd(m.width);
+		const __m128 x0 = _mm_set1_ps(m.x0);
+		const __m128 x1 = _mm_set1_ps(m.x1);
+		const __m128 min_w = _mm_set1_ps(2.0f);
+
+		for (; i + 2 <= n; i += 2) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)(segs + i));
+			const __m128i b = _mm_loadu_si128((const __m128i *)(segs + i + 1));
+			const __m128d start = dz_i64_to_pd(_mm_unpacklo_epi64(a, b));
+			__m128d end = dz_i64_to_pd(_mm_unpackhi_epi64(a, b));
+			const __m128d held = _mm_cmplt_pd(end, _mm_setzero_pd());
+			end = _mm_or_pd(_mm_and_pd(held, t_now), _mm_andnot_pd(held, end));
+
+			const __m128d us = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(start, t0), denom), width);
+			const __m128d ue = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(end, t0), denom), width);
+
+			// (xs0 xs1 xe0 xe1), clamped together
+			__m128 v = _mm_movelh_ps(_mm_cvtpd_ps(us), _mm_cvtpd_ps(ue));
+			v = _mm_max_ps(x0, _mm_min_ps(x1, _mm_add_ps(x0, v)));
+			_mm_storel_pi((__m64 *)(x + i), v);
+			_mm_storel_pi((__m64 *)(w + i), _mm_max_ps(min_w, _mm_sub_ps(_mm_movehl_ps(v, v), v)));
+		}
+	}
+	dz_map_segments_scalar(m, segs + i, n - i, x + i, w + i);
+}
+#else
+const char *const dz_map_segments_isa = "scalar";
+
+void dz_map_segments(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w)
+{
+	dz_map_segments_scalar(m, segs, n, x, w);
+}
+#endif
+
+void dz_build_timeline(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+		       dz_batch *batch)
+{
+	if (L.visible_rows <= 0)
+		return;
+
+	const float rowH = L.rowH;
+
+	// Time window (moving)
+	const int64_t t0 = tNow - s->window_us;
+	const int64_t t1 = tNow;
+	const dz_x_map m = dz_make_x_map(L, t0, t1, tNow);
+
+	// Key segments (height 60% of rowH, sharp corners)
+	// Only the visible slice of each row is walked: binary search to the first segment
+	// that ends inside the window and past the last one starting in it, then map the
+	// slice in contiguous chunks straight into the batch.
+	{
+		const float h = dz_bar_height(rowH);
+		float xs[256], ws[256];
+
+		for (int v = 0; v < L.visible_rows; v++) {
+			const int row = s->visible_row[v];
+			const dz_history<dz_key_segment> &segs = tl->rows[row].segments;
+			const float y = L.rowYs[row] + std::round((rowH - h) * 0.5f);
+			const vec4 c = dz_row_color(s, row, 0.95f);
+			const uint32_t rgba = vec4_to_rgba(&c);
+
+			const uint32_t first = segs.partition_point(
+				[&](const dz_key_segment &seg) { return seg.end_us >= 0 && seg.end_us < t0; });
+			const uint32_t last =
+				segs.partition_point([&](const dz_key_segment &seg) { return seg.start_us <= t1; });
+
+			for (uint32_t i = first; i < last;) {
+				const uint32_t n = std::min(segs.contiguous(i, last - i), (uint32_t)std::size(xs));
+				dz_map_segments(m, segs.data(i), n, xs, ws);
+				dz_batch_spans(batch, xs, ws, n, y, h, rgba);
+				i += n;
+			}
+		}
+	}
+
+	// Click markers + delta numbers
+	for (int v = 0; v < L.visible_rows; v++) {
+		const int row = s->visible_row[v];
+		const dz_history<dz_click_event> &clicks = tl->rows[row].clicks;
+
+		// Color + height are driven by the last key pressed before the click (its row).
+		// One variable controls both the click line and the delta number color.
+		const vec4 clickCol = dz_row_color(s, row, 0.90f);
+
+		// Click line: starts at the TOP of the row of the last key, ends at the baseline.
+		const float y0 = L.rowYs[row];
+		const float h = std::max(2.0f, L.axisY2 - y0);
+
+		const uint32_t first = clicks.partition_point([&](const dz_click_event &c) { return c.time_us < t0; });
+
+		for (uint32_t i = first; i < clicks.size(); i++) {
+			const dz_click_event &c = clicks[i];
+			if (c.time_us > t1)
+				break;
+
+			const float x = dz_map_x(m, c.time_us);
+			dz_batch_rect(batch, x, y0, 2.0f, h, clickCol);
+
+			// Number near the row (same color as the click line)
+			const float scale = 3.0f;
+			const float yText = L.rowYs[row] - 6.0f;
+			dz_draw_text_5x7(batch, x + 6.0f, yText + 0.1f, c.label, scale, clickCol);
+		}
+	}
+}
+
+static inline void dz_put_texel(float *t, float x, float y, float z, float w)
+{
+	t[0] = x;
+	t[1] = y;
+	t[2] = z;
+	t[3] = w;
+}
+
+// Label characters as font codes: digits, '.', '-', anything else blank
+static const char kGpuGlyphs[] = "0123456789.-";
+
+static uint32_t dz_gpu_glyph_code(char ch)
+{
+	const char *p = ch ? strchr(kGpuGlyphs, ch) : nullptr;
+	return p ? (uint32_t)(p - kGpuGlyphs) : 15;
+}
+
+// Same content as dz_build_timeline, as data for the shader. Only what the shader reads is
+// written: it may be a freshly discarded mapping. Items already out of the window are skipped,
+// and like dz_build_timeline, so are items after tNow (replay after a seek back, live stamps
+// past the frame time). The texture stays valid as the window moves on, since anything new
+// comes with an event, until tNow reaches *later_us: the first item left out (INT64_MAX if none).
+// False if some row has clicks closer together than the shader can draw (see
+// DZ_GPU_CLICK_CANDIDATES), so the caller draws them on the CPU instead.
+bool dz_build_gpu_timeline(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+			   int64_t base_us, float *texels, size_t row_floats, int64_t *later_us)
+{
+	const int64_t t0 = tNow - s->window_us;
+	const float rowH = L.rowH;
+	const float h = dz_bar_height(rowH);
+	const uint32_t max_segments = DZ_GPU_TEX_WIDTH - DZ_GPU_HEADER_TEXELS;
+	const double reach_us = DZ_GPU_CLICK_REACH * (double)s->window_us / std::max(1.0f, L.timelineW);
+	bool fits = true;
+	*later_us = INT64_MAX;
+
+	for (int v = 0; v < L.visible_rows; v++) {
+		const int row = s->visible_row[v];
+		const dz_history<dz_key_segment> &segs = tl->rows[row].segments;
+		const dz_history<dz_click_event> &clicks = tl->rows[row].clicks;
+		float *hdr = texels + v * row_floats;
+
+		// Newest items win if a row ever holds more than the texture is wide
+		uint32_t first = segs.partition_point(
+			[&](const dz_key_segment &seg) { return seg.end_us >= 0 && seg.end_us < t0; });
+		const uint32_t last =
+			segs.partition_point([&](const dz_key_segment &seg) { return seg.start_us <= tNow; });
+		first = std::max(first, last > max_segments ? last - max_segments : 0);
+		if (last < segs.size())
+			*later_us = std::min(*later_us, segs[last].start_us);
+		uint32_t n_segs = 0;
+		for (uint32_t i = first; i < last; i++) {
+			const dz_key_segment &seg = segs[i];
+			const float end = seg.end_us < 0 ? 1e30f : (float)(seg.end_us - base_us);
+			dz_put_texel(hdr + (DZ_GPU_HEADER_TEXELS + n_segs++) * 4, (float)(seg.start_us - base_us), end, 0.0f,
+				     0.0f);
+		}
+
+		uint32_t first_click = clicks.partition_point([&](const dz_click_event &c) { return c.time_us < t0; });
+		const uint32_t last_click =
+			clicks.partition_point([&](const dz_click_event &c) { return c.time_us <= tNow; });
+		first_click = std::max(first_click, last_click > DZ_GPU_TEX_WIDTH ? last_click - DZ_GPU_TEX_WIDTH : 0);
+		if (last_click < clicks.size())
+			*later_us = std::min(*later_us, clicks[last_click].time_us);
+		uint32_t n_clicks = 0;
+		uint32_t reach_first = first_click; // oldest click within reach of click i
+		float *click_row = texels + (DZ_MAX_ROWS + v) * row_floats;
+		for (uint32_t i = first_click; i < last_click; i++) {
+			const dz_click_event &c = clicks[i];
+			while ((double)(c.time_us - clicks[reach_first].time_us) >= reach_us)
+				reach_first++;
+			if (i - reach_first >= DZ_GPU_CLICK_CANDIDATES)
+				fits = false;
+			uint32_t code[2] = {0, 0};
+			const size_t len = strnlen(c.label, sizeof(c.label));
+			for (size_t k = 0; k < len; k++)
+				code[k / 6] |= dz_gpu_glyph_code(c.label[k]) << (k % 6 * 4);
+			dz_put_texel(click_row + n_clicks++ * 4, (float)(c.time_us - base_us), (float)len, (float)code[0],
+				     (float)code[1]);
+		}
+
+		const float y = L.rowYs[row];
+		dz_put_texel(hdr, y + std::round((rowH - h) * 0.5f), h, (float)n_segs, (float)n_clicks);
+		const vec4 seg_col = dz_row_color(s, row, 0.95f);
+		const vec4 click_col = dz_row_color(s, row, 0.90f);
+		dz_put_texel(hdr + 4, seg_col.x, seg_col.y, seg_col.z, seg_col.w);
+		dz_put_texel(hdr + 8, click_col.x, click_col.y, click_col.z, click_col.w);
+		dz_put_texel(hdr + 12, y, std::max(2.0f, L.axisY2 - y), y - 6.0f + 0.1f, 0.0f);
+	}
+
+	float *font = texels + DZ_GPU_FONT_ROW * row_floats;
+	for (uint32_t code = 0; code < DZ_GPU_FONT_GLYPHS; code++) {
+		const uint64_t glyph = code < sizeof(kGpuGlyphs) - 1 ? glyph_5x7(kGpuGlyphs[code]) : 0;
+		uint32_t words[3] = {0, 0, 0};
+		for (int r = 0; r < 7; r++)
+			words[r / 3] |= (uint32_t)((glyph >> (r * 8)) & 0x1f) << (r % 3 * 5);
+		dz_put_texel(font + code * 4, (float)words[0], (float)words[1], (float)words[2], 0.0f);
+	}
+	return fits;
+}
+
+// Counter-strafe summary under the axis labels (ms)
+void dz_build_stats_strip(const dz_settings *s, dz_timeline *tl, const dz_layout &L, dz_batch *batch)
+{
+	if (!s->show_stats)
+		return;
+
+	const vec4 col = dz_col_rgba(1.0f, 1.0f, 1.0f, 0.75f);
+	dz_draw_text_5x7(batch, L.timelineX0, L.axisY + 32.0f, dz_strafe_label(&tl->strafe), 2.0f, col);
+}
+
+// Mouse velocity envelope: one min/max line per pixel column of the timeline, 2 vertices
+// each, so the lane never takes more than 2 * timelineW vertices (7680 at 4K).
+// Columns wider than a coarse bucket read the coarse level, so the work per frame
+// is bounded by the column count rather than the mouse polling rate. Bins are in time
+// order, so one pass folds each column and emits it once the next one starts.
+void dz_build_motion_lane(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+			  dz_batch *batch)
+{
+	if (L.laneY < 0.0f || !tl->motion.capacity || L.timelineW < 1.0f)
+		return;
+
+	const int64_t window_us = s->window_us;
+	const int64_t t0 = tNow - window_us;
+	const int cols = (int)L.timelineW;
+	const double col_us = (double)window_us / (double)cols;
+
+	const bool coarse = col_us >= (double)DZ_MOTION_COARSE_US;
+	const dz_history<dz_motion_bin> &bins = coarse ? tl->motion.coarse : tl->motion.fine;
+
+	// A column with fewer bins than milliseconds had idle time in it: its floor is zero
+	const uint32_t full = (uint32_t)std::max(1.0, std::floor(col_us / (double)DZ_MOTION_BIN_US));
+	const float laneH = L.rowH;
+	const float base = L.laneY + laneH;
+	const float k = laneH / (float)s->motion_full_scale;
+	const vec4 col = dz_col_rgba(0.85f, 0.85f, 0.85f, 0.85f);
+	const uint32_t rgba = vec4_to_rgba(&col);
+
+	const size_t at = batch->points.size();
+	batch->points.resize(at + (size_t)cols * 2);
+	vec3 *v = batch->points.data() + at;
+
+	// Column c holds [t0 + ceil(c * window / cols), the same for c + 1)
+	int c = 0;
+	int64_t next_us = t0 + (window_us + cols - 1) / cols;
+	uint32_t lo = UINT32_MAX, hi = 0, count = 0;
+	auto emit = [&]() {
+		if (!hi)
+			return;
+		// Through the pixel centers, at least one pixel long
+		const float x = L.timelineX0 + (float)c + 0.5f;
+		const float yHi = base - std::min(laneH, (float)hi * k);
+		const float yLo = base - std::min(laneH, (float)(count < full ? 0 : lo) * k);
+		vec3_set(v++, x, yHi, 0.0f);
+		vec3_set(v++, x, std::max(yHi + 1.0f, yLo), 0.0f);
+	};
+
+	const uint32_t first = bins.partition_point([&](const dz_motion_bin &b) { return b.time_us < t0; });
+	for (uint32_t i = first; i < bins.size();) {
+		const uint32_t n = bins.contiguous(i, bins.size() - i);
+		const dz_motion_bin *b = bins.data(i);
+		for (uint32_t j = 0; j < n; j++) {
+			if (b[j].time_us >= next_us && c < cols - 1) {
+				emit();
+				lo = UINT32_MAX;
+				hi = count = 0;
+				c = (int)std::min<int64_t>(cols - 1, (b[j].time_us - t0) * cols / window_us);
+				next_us = t0 + (window_us * (c + 1) + cols - 1) / cols;
+			}
+			lo = std::min(lo, b[j].lo);
+			hi = std::max(hi, b[j].hi);
+			count += b[j].count;
+		}
+		i += n;
+	}
+	emit();
+
+	const size_t n = (size_t)(v - (batch->points.data() + at));
+	batch->points.resize(at + n);
+	batch->colors.resize(at + n, rgba);
+	if (n) {
+		batch->lines_first = at;
+		batch->lines_count = n;
+	}
+}
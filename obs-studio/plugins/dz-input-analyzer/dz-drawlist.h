@@ -0,0 +1,181 @@
+// plugins/dz-input-analyzer/dz-drawlist.h
+//
+// CPU side of drawing: layout and the triangle lists for the static layer and the
+// moving timeline. Only libobs' vector math is used, so the headless benchmark can
+// build the same geometry the plugin uploads.
+#pragma once
+
+#include <graphics/vec3.h>
+#include <graphics/vec4.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "dz-timeline.h"
+
+struct gs_vertex_buffer;
+
+// Triangle list with per-vertex color (drawn with the solid effect's "SolidColored" technique).
+// One run of it may be a line list instead (the motion lane), drawn in its place.
+struct dz_batch {
+	std::vector<vec3> points;
+	std::vector<uint32_t> colors;
+	size_t lines_first = 0; // first vertex of the line run
+	size_t lines_count = 0;
+
+	// GPU copy, owned by the plugin
+	struct gs_vertex_buffer *vb = nullptr;
+	size_t vb_capacity = 0; // vertices
+	size_t vb_count = 0;    // vertices uploaded by the last upload
+	size_t vb_lines_first = 0;
+	size_t vb_lines_count = 0;
+};
+
+inline void dz_batch_quad(dz_batch *b, float x, float y, float w, float h, uint32_t rgba)
+{
+	vec3 v[6];
+	vec3_set(&v[0], x, y, 0.0f);
+	vec3_set(&v[1], x + w, y, 0.0f);
+	vec3_set(&v[2], x, y + h, 0.0f);
+	vec3_set(&v[3], x + w, y, 0.0f);
+	vec3_set(&v[4], x + w, y + h, 0.0f);
+	vec3_set(&v[5], x, y + h, 0.0f);
+	b->points.insert(b->points.end(), v, v + 6);
+	b->colors.insert(b->colors.end(), 6, rgba);
+}
+
+inline void dz_batch_rect(dz_batch *b, float x, float y, float w, float h, const vec4 &c)
+{
+	dz_batch_quad(b, x, y, w, h, vec4_to_rgba(&c));
+}
+
+// n bars of height h at y in one color, x[i] to x[i] + w[i]; grows the batch once
+inline void dz_batch_spans(dz_batch *b, const float *x, const float *w, uint32_t n, float y, float h, uint32_t rgba)
+{
+	const size_t at = b->points.size();
+	b->points.resize(at + (size_t)n * 6);
+	b->colors.resize(at + (size_t)n * 6, rgba);
+
+	vec3 *v = b->points.data() + at;
+	for (uint32_t i = 0; i < n; i++, v += 6) {
+		const float x1 = x[i] + w[i];
+		vec3_set(&v[0], x[i], y, 0.0f);
+		vec3_set(&v[1], x1, y, 0.0f);
+		vec3_set(&v[2], x[i], y + h, 0.0f);
+		vec3_set(&v[3], x1, y, 0.0f);
+		vec3_set(&v[4], x1, y + h, 0.0f);
+		vec3_set(&v[5], x[i], y + h, 0.0f);
+	}
+}
+
+inline void dz_batch_clear(dz_batch *b)
+{
+	b->points.clear();
+	b->colors.clear();
+	b->lines_first = 0;
+	b->lines_count = 0;
+}
+
+// Colors from movv.html
+inline vec4 dz_col_rgba(float r, float g, float b, float a)
+{
+	vec4 c;
+	vec4_set(&c, r, g, b, a);
+	return c;
+}
+
+// OBS color property uses Windows COLORREF (BGR): 0x00BBGGRR
+inline vec4 dz_col_from_obs_bgr(uint32_t bgr, float a)
+{
+	const float r = (float)((bgr) & 0xFF) / 255.0f;
+	const float g = (float)((bgr >> 8) & 0xFF) / 255.0f;
+	const float b = (float)((bgr >> 16) & 0xFF) / 255.0f;
+	return dz_col_rgba(r, g, b, a);
+}
+
+// Layout copied from movv.html draw()
+struct dz_layout {
+	float W = 0.0f;
+	float H = 0.0f;
+	float topPad = 18.0f;
+	float bottomPad = 55.0f;
+	float rowGap = 20.0f;
+
+	float timelineX0 = 0.0f;
+	float timelineX1 = 0.0f;
+	float timelineW = 0.0f;
+
+	float rowH = 0.0f;
+	float rowYs[DZ_MAX_ROWS];
+	int visible_rows = 0;
+	float laneY = -1.0f; // mouse lane, below the last visible row
+
+	float axisY = 0.0f;
+	float axisY2 = 0.0f; // baseline thickness
+};
+
+// Time to x of the moving timeline: [t0, t1] onto [timelineX0, timelineX1]
+struct dz_x_map {
+	int64_t t0 = 0;
+	int64_t t_now = 0; // where a held key's bar ends
+	double denom = 0.0;
+	double width = 0.0;
+	float x0 = 0.0f;
+	float x1 = 0.0f;
+};
+
+inline dz_x_map dz_make_x_map(const dz_layout &L, int64_t t0, int64_t t1, int64_t t_now)
+{
+	dz_x_map m;
+	m.t0 = t0;
+	m.t_now = t_now;
+	m.denom = (double)(t1 - t0);
+	m.width = (double)L.timelineW;
+	m.x0 = L.timelineX0;
+	m.x1 = L.timelineX1;
+	return m;
+}
+
+// Bar of each segment, clamped to the timeline: x[i] at its start, w[i] >= 2 up to its end.
+// Runs 2 (SSE2) or 4 (AVX2) segments a step when the build targets them, with results
+// bit-identical to the scalar version; times must stay below 2^51 us.
+void dz_map_segments(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w);
+void dz_map_segments_scalar(const dz_x_map &m, const dz_key_segment *segs, uint32_t n, float *x, float *w);
+extern const char *const dz_map_segments_isa;
+
+// Event texture for data/dz-timeline.effect (RGBA32F), filled by dz_build_gpu_timeline.
+// Times are in us from a base time picked by the caller.
+// Texel row v < DZ_MAX_ROWS, for the v-th visible row:
+//   0: bar y, bar height, segment count, click count
+//   1: segment color, 2: click color, 3: click line y, line height, label y
+//   4+: segments (start, end); end is huge while the key is held
+// Texel row DZ_MAX_ROWS + v: clicks (time, label length, label chars 0-5, chars 6-11), 4 bits a char
+// Texel row DZ_GPU_FONT_ROW: digit glyphs, 3 glyph rows of 5 bits per channel
+static constexpr int DZ_GPU_TEX_WIDTH = 2048;
+static constexpr int DZ_GPU_HEADER_TEXELS = 4;
+static constexpr int DZ_GPU_FONT_ROW = 2 * DZ_MAX_ROWS;
+static constexpr int DZ_GPU_FONT_GLYPHS = 16;
+static constexpr int DZ_GPU_TEX_HEIGHT = DZ_GPU_FONT_ROW + 1;
+
+// A pixel looks at CLICK_CANDIDATES clicks from the one LABEL_OFFSET + LABEL_MAX_W px to its
+// left (values in the effect); more than that within the span and some are never drawn
+static constexpr uint32_t DZ_GPU_CLICK_CANDIDATES = 16;
+static constexpr float DZ_GPU_CLICK_REACH = 210.0f;
+
+void dz_draw_text_5x7(dz_batch *batch, float x, float y, const char *text, float scale, const vec4 &color);
+vec4 dz_row_color(const dz_settings *s, int row, float a);
+
+float dz_bottom_pad(const dz_settings *s);
+float dz_base_row_height(const dz_settings *s);
+float dz_visible_height(const dz_settings *s);
+void dz_compute_layout(const dz_settings *s, dz_layout *L);
+
+void dz_build_static_layer(const dz_settings *s, const dz_layout &L, dz_batch *batch);
+void dz_build_timeline(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+		       dz_batch *batch);
+bool dz_build_gpu_timeline(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+			   int64_t base_us, float *texels, size_t row_floats, int64_t *later_us);
+void dz_build_stats_strip(const dz_settings *s, dz_timeline *tl, const dz_layout &L, dz_batch *batch);
+void dz_build_motion_lane(const dz_settings *s, const dz_timeline *tl, const dz_layout &L, int64_t tNow,
+			  dz_batch *batch);
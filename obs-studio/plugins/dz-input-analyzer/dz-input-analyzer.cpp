@@ -5,6 +5,11 @@
 #define LIBOBS_API_VER obs_get_version()
 #include <graphics/graphics.h>
 #include <graphics/vec4.h>
+#include <util/threading.h>
+#include <util/platform.h>
+#if defined(DZ_FRONTEND_API)
+#include <obs-frontend-api.h>
+#endif
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -14,11 +19,15 @@
 #include <cstdint>
 #include <algorithm>
 #include <vector>
-#include <deque>
-#include <chrono>
 #include <cmath>
 #include <string>
 #include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "dz-timeline.h"
+#include "dz-drawlist.h"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("dz-input-analyzer", "en-US")
@@ -27,95 +36,446 @@ static const wchar_t *kWndClass = L"DZ_Input_Analyzer_Window";
 
 // ------------------------------------------------------------
 // Timing helpers
-static inline int64_t now_ms()
+static inline int64_t now_us()
+{
+	static const int64_t freq = [] {
+		LARGE_INTEGER f;
+		QueryPerformanceFrequency(&f);
+		return (int64_t)f.QuadPart;
+	}();
+
+	LARGE_INTEGER c;
+	QueryPerformanceCounter(&c);
+	const int64_t q = (int64_t)c.QuadPart;
+	return (q / freq) * 1000000 + (q % freq) * 1000000 / freq;
+}
+
+// Stamped by the capture loop as soon as a message is dequeued (capture thread only).
+// MSG::time / GetMessageTime only have tick-count resolution, so QPC is taken here instead.
+static thread_local int64_t tls_msg_time_us = 0;
+
+static inline int64_t dz_input_time_us()
+{
+	return tls_msg_time_us != 0 ? tls_msg_time_us : now_us();
+}
+
+// Timestamp of the video frame being rendered, on the capture clock: os_gettime_ns and
+// now_us both count QPC ticks, so frame times and input stamps compare directly. Every
+// render of one frame (preview, projectors, program) sees the same instant, and it
+// advances by exactly one frame interval each frame.
+static inline int64_t dz_frame_time_us()
+{
+	const uint64_t t = obs_get_video_frame_time();
+	return t ? (int64_t)(t / 1000) : now_us();
+}
+
+// Same clock, for the frame after the one being rendered
+static inline int64_t dz_next_frame_time_us()
 {
-	using namespace std::chrono;
-	return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+	const uint64_t t = obs_get_video_frame_time();
+	return t ? (int64_t)((t + obs_get_frame_interval_ns()) / 1000) : now_us();
 }
 
 // ------------------------------------------------------------
-// Timeline model (matches movv.html logic)
-enum dz_row : int { ROW_W = 0, ROW_S = 1, ROW_A = 2, ROW_D = 3, ROW_COUNT = 4 };
+// Instrumentation
+//
+// Log-linear histogram (4 buckets per power of two) of nanosecond or count samples.
+// Buckets are only ever added to: a reader keeps a snapshot and takes percentiles of the
+// difference, so the capture thread records without locks and nobody resets anything.
+static constexpr int DZ_PERF_BUCKETS = 160;
+static constexpr int64_t DZ_PERF_OVERLAY_US = 1000000; // overlay refresh
+static constexpr int64_t DZ_PERF_LOG_US = 10000000;    // log summary period
+
+static inline int dz_perf_bucket(uint64_t v)
+{
+	if (v < 8)
+		return (int)v;
+	unsigned long e;
+	_BitScanReverse64(&e, v);
+	return std::min<int>((int)(e - 1) * 4 + (int)((v >> (e - 2)) & 3), DZ_PERF_BUCKETS - 1);
+}
+
+// Midpoint of a bucket, in sample units
+static inline double dz_perf_bucket_mid(int b)
+{
+	if (b < 8)
+		return (double)b;
+	const int e = b / 4 + 1;
+	const uint64_t width = 1ull << (e - 2);
+	return (double)((4 + (uint64_t)(b % 4)) * width) + (double)width / 2.0;
+}
+
+struct dz_perf_hist {
+	std::atomic<uint32_t> buckets[DZ_PERF_BUCKETS] = {};
+
+	void add(uint64_t v) { buckets[dz_perf_bucket(v)].fetch_add(1, std::memory_order_relaxed); }
+};
+
+struct dz_perf_snapshot {
+	uint32_t buckets[DZ_PERF_BUCKETS] = {};
+};
+
+struct dz_perf_summary {
+	uint32_t count = 0;
+	double p50 = 0.0;
+	double p99 = 0.0;
+};
+
+static void dz_perf_take(const dz_perf_hist &h, dz_perf_snapshot *out)
+{
+	for (int b = 0; b < DZ_PERF_BUCKETS; b++)
+		out->buckets[b] = h.buckets[b].load(std::memory_order_relaxed);
+}
+
+// Percentiles of everything added between 'then' and 'now'
+static dz_perf_summary dz_perf_summarize(const dz_perf_snapshot &now, const dz_perf_snapshot &then)
+{
+	uint32_t diff[DZ_PERF_BUCKETS];
+	dz_perf_summary s;
+	for (int b = 0; b < DZ_PERF_BUCKETS; b++) {
+		diff[b] = now.buckets[b] - then.buckets[b];
+		s.count += diff[b];
+	}
+	if (!s.count)
+		return s;
+
+	const uint32_t r50 = std::max<uint32_t>(1, (uint32_t)std::ceil(0.5 * s.count));
+	const uint32_t r99 = std::max<uint32_t>(1, (uint32_t)std::ceil(0.99 * s.count));
+	uint32_t acc = 0;
+	bool have50 = false;
+	for (int b = 0; b < DZ_PERF_BUCKETS; b++) {
+		acc += diff[b];
+		if (!have50 && acc >= r50) {
+			s.p50 = dz_perf_bucket_mid(b);
+			have50 = true;
+		}
+		if (acc >= r99) {
+			s.p99 = dz_perf_bucket_mid(b);
+			break;
+		}
+	}
+	return s;
+}
 
-struct dz_key_segment {
-	int row = 0;          // 0..3
-	int64_t start_ms = 0; // absolute ms
-	int64_t end_ms = -1;  // -1 while pressed
+enum dz_perf_metric_id : int {
+	DZ_PERF_RENDER,  // CPU time in dz_source_render, ns
+	DZ_PERF_LATENCY, // key/click capture to the end of the first frame that drew it, ns
+	DZ_PERF_DEPTH,   // events waiting in the ring when the frame drained it
+	DZ_PERF_WNDPROC, // capture thread time per raw input record, ns (the hub's histogram)
+	DZ_PERF_METRICS
 };
 
-struct dz_click_event {
-	int row = ROW_D;     // row to print delta
-	int64_t time_ms = 0; // absolute ms
-	int delta_ms = 0;    // >= 0
+struct dz_perf_marks {
+	dz_perf_snapshot overlay; // start of the current overlay period
+	dz_perf_snapshot log;     // start of the current log period
 };
 
+// Per-source instrumentation (render thread only, except where noted)
+struct dz_perf {
+	dz_perf_hist hists[DZ_PERF_WNDPROC]; // the wndproc histogram lives in the hub
+	dz_perf_marks marks[DZ_PERF_METRICS];
+	dz_perf_summary overlay[DZ_PERF_METRICS]; // last completed overlay period
+
+	// Capture stamps of the key/click events this frame put on screen for the first time
+	std::vector<int64_t> drained_us;
+
+	uint32_t draws = 0; // draw calls last frame
+	uint32_t rects = 0; // batched rects last frame
+	uint32_t max_rects = 0;
+
+	uint32_t log_dropped = 0; // counters at the start of the log period
+	uint32_t log_mouse = 0;
+	uint32_t log_keys = 0;
+	uint32_t log_frames = 0;
+	uint32_t frames = 0;
+
+	int64_t overlay_due_us = 0;
+	int64_t log_due_us = 0;
+	char label[3][80] = {};
+};
+
+// Raw input totals for readers on other threads. Buttons and keys are written as they
+// happen; motion is accumulated per capture thread and published in batches, on its own
+// cache line so readers of one never contend with writes to the other.
 struct dz_input_state {
-	std::atomic<uint8_t> key_down[ROW_COUNT]{{0}, {0}, {0}, {0}};
-	std::atomic<uint8_t> m1{0}, m2{0}, m3{0};
+	alignas(64) std::atomic<uint8_t> m1{0}, m2{0}, m3{0};
+	std::atomic<uint32_t> key_events{0};
 
-	std::atomic<int> last_dx{0};
+	alignas(64) std::atomic<int> last_dx{0};
 	std::atomic<int> last_dy{0};
-
 	std::atomic<int64_t> total_dx{0};
 	std::atomic<int64_t> total_dy{0};
-
 	std::atomic<uint32_t> mouse_events{0};
-	std::atomic<uint32_t> key_events{0};
 };
 
+// Motion published to dz_input_state at most this often
+static constexpr int64_t DZ_MOTION_PUBLISH_US = 4000;
+
+// Motion not yet published (capture thread only)
+struct dz_motion_accum {
+	int last_dx = 0;
+	int last_dy = 0;
+	int64_t dx = 0;
+	int64_t dy = 0;
+	uint32_t events = 0;
+	int64_t published_us = 0;
+};
+
+static thread_local dz_motion_accum tls_motion;
+
+struct dz_replay_file;
+
+struct dz_replay_cursor {
+	uint32_t page = 0;
+	uint32_t index = 0;
+	int64_t last_us = 0; // replay time of the previous frame
+	bool valid = false;
+};
+
+// Settings snapshot plus what only the plugin needs. Built on the UI thread by
+// dz_source_update and handed to the render thread through dz_source_data::pending;
+// never modified once published.
+struct dz_source_settings : dz_settings {
+	~dz_source_settings();
+
+	// Replay: the timeline is fed from a mapped session file instead of live input.
+	// Both are owned by the snapshot and released with it.
+	dz_replay_file *replay_file = nullptr;
+	obs_weak_source_t *replay_media = nullptr; // media source whose time drives playback
+	int64_t replay_offset_us = 0;
+
+	// Build each frame's moving layer on a worker during the previous frame
+	bool async_build = true;
+};
+
+// Per-row setting names and defaults. Rows 0-3 keep their original w/s/a/d setting
+// names so existing scenes load unchanged; extra rows default to common game binds.
+struct dz_row_default {
+	const char *id;
+	uint16_t vkey;
+	uint32_t color; // BGR
+};
+
+static const dz_row_default kRowDefaults[DZ_MAX_ROWS] = {
+	{"w", 'W', 0x005dc8f3},        // #f3c85d
+	{"s", 'S', 0x009cff9c},        // #9cff9c
+	{"a", 'A', 0x003f3fcf},        // #cf3f3f
+	{"d", 'D', 0x00c8a00a},        // #0aa0c8
+	{"5", VK_CONTROL, 0x00d77fb4}, // crouch, #b47fd7
+	{"6", VK_SPACE, 0x003c7ae0},   // jump, #e07a3c
+	{"7", VK_SHIFT, 0x00e0c03c},   // sprint/walk, #3cc0e0
+	{"8", 'R', 0x003ce0e0},        // reload, #e0e03c
+	{"9", '1', 0x00b08fff},        // #ff8fb0
+	{"10", '2', 0x00ffb08f},       // #8fb0ff
+	{"11", '3', 0x008fffb0},       // #b0ff8f
+	{"12", '4', 0x008fd0ff},       // #ffd08f
+	{"13", 'Q', 0x00ff8fd0},       // #d08fff
+	{"14", 'E', 0x00d0ff8f},       // #8fffd0
+	{"15", 'F', 0x00c0c0c0},       // #c0c0c0
+	{"16", 'G', 0x006060ff},       // #ff6060
+};
+
+// Setting name for a row, e.g. dz_row_setting(buf, "row_%s_key", 0) -> "row_w_key"
+static const char *dz_row_setting(char (&buf)[32], const char *fmt, int row)
+{
+	_snprintf_s(buf, _TRUNCATE, fmt, kRowDefaults[row].id);
+	return buf;
+}
+
+struct dz_recorder;
+struct dz_telemetry;
+
+// One frame of the moving layer: the inputs it is built from and the CPU results
+struct dz_moving_frame {
+	const dz_source_settings *cfg = nullptr;
+	int64_t t_now = 0;
+	uint32_t revision = 0;
+	bool idle = false;
+	bool gpu = false;   // key segments and clicks are left to the shader
+	bool built = false; // false: what is uploaded is still current
+
+	dz_batch batch; // vertices only; swapped with dz_source_data::batch on commit
+
+	// Event texture contents, when they need an upload
+	bool events_filled = false;
+	bool events_crowded = false;
+	int64_t events_base_us = 0;
+	int64_t events_later_us = INT64_MAX;
+	std::vector<float> events;
+
+	// Capture stamps of the key/click events drained into the timeline it is built from
+	// and not drawn yet (while instrumentation is on)
+	std::vector<int64_t> drained_us;
+};
+
+struct dz_source_data;
+
+// One worker builds for every source with async building on, in the order their frames
+// were handed over; it runs while at least one of them is
+struct dz_builder {
+	std::mutex users_lock; // start/stop
+	int users = 0;
+	std::thread thread;
+
+	std::mutex lock;
+	std::condition_variable cv;
+	std::vector<dz_source_data *> queue; // handed over, not started yet
+	bool quit = false;
+};
+
+static dz_builder g_builder;
+
 struct dz_source_data {
-	// Source size
-	uint32_t width = 1500;
-	uint32_t height = 520;
-
-	// Visual config
-	float bg_alpha = 0.55f;
-	bool row_enabled[ROW_COUNT] = {true, true, true, true};
-	uint16_t row_key_vkey[ROW_COUNT] = {'W', 'S', 'A', 'D'};
-
-	// Colors (OBS color picker gives BGR: 0x00BBGGRR)
-	uint32_t bg_color = 0x000000; // background RGB in OBS BGR encoding (default black)
-	uint32_t key_color[ROW_COUNT] = {
-		0x005dc8f3, // W: #f3c85d
-		0x009cff9c, // S: #9cff9c
-		0x003f3fcf, // A: #cf3f3f
-		0x00c8a00a  // D: #0aa0c8
-	};
+	obs_source_t *source = nullptr;
 
-	// OBS effect
-	gs_effect_t *solid = nullptr;
+	// Session recorder, toggled by a hotkey or with OBS recording
+	dz_recorder *recorder = nullptr;
+	obs_hotkey_id record_hotkey = OBS_INVALID_HOTKEY_ID;
 
-	// Raw input window
-	HWND hwnd = nullptr;
+	// Live telemetry export into shared memory
+	dz_telemetry *telemetry = nullptr;
 
-	// Input state (raw)
-	dz_input_state st;
+	// Settings in use by the render thread (render thread only)
+	dz_source_settings *cfg = nullptr;
 
-	// Timeline storage
-	std::deque<dz_key_segment> segments;
-	std::deque<dz_click_event> clicks;
+	// Latest snapshot from dz_source_update not yet picked up by the render thread.
+	// Whoever exchanges it out owns it, so no reader ever sees a freed snapshot.
+	std::atomic<dz_source_settings *> pending{nullptr};
 
-	// movv.html behavior: store "last keydown" (row + time)
-	std::atomic<int> last_key_row{ROW_D};
-	std::atomic<int64_t> last_key_down_ms{0};
-	std::atomic<int> last_key_valid{0};
+	// Source size as reported to OBS, updated with each published snapshot
+	std::atomic<uint32_t> out_cx{0};
+	std::atomic<uint32_t> out_cy{0};
+
+	// OBS effect
+	gs_effect_t *solid = nullptr;
+	gs_eparam_t *solid_color = nullptr;
+
+	gs_effect_t *image_effect = nullptr;
+	gs_eparam_t *image_param = nullptr;
+
+	// Shader timeline (data/dz-timeline.effect); null if it failed to load
+	gs_effect_t *timeline_effect = nullptr;
+	gs_eparam_t *timeline_image = nullptr;
+	gs_eparam_t *timeline_size = nullptr;
+	gs_eparam_t *timeline_window = nullptr;
+	gs_eparam_t *timeline_extent = nullptr;
+
+	// Its event texture, refilled when the timeline revision moves on
+	gs_texture_t *timeline_events = nullptr;
+	int64_t events_base_us = 0;
+	uint32_t events_revision = 0;
+	bool events_dirty = true;
+	bool events_crowded = false; // clicks too dense for the shader in what is uploaded
+	int64_t events_later_us = INT64_MAX; // first item left out of it for being after its tNow
+
+	// Moving geometry (rects + text) as uploaded, drawn once per frame
+	dz_batch batch;
+	dz_layout layout; // computed once per settings snapshot
+
+	// The next frame's moving layer, owned by the builder while it is queued
+	dz_moving_frame moving;
+	bool async_build = false;   // using g_builder
+	bool build_busy = false;    // handed over and not finished (under g_builder.lock)
+	bool moving_queued = false; // handed over since the last wait (render thread)
+
+	// What the uploaded moving geometry was built from. While it cannot differ from a
+	// rebuild, the frame redraws the vertex buffer as is (render thread only).
+	uint32_t drawn_revision = 0;
+	int64_t drawn_us = 0;
+	bool drawn_idle = false;
+	bool drawn_gpu = false;   // key segments and clicks were left to the shader
+	bool moving_dirty = true; // settings, static layer or overlay changed
+
+	// Static layer (background, grid, labels, axis), re-rendered only on settings change
+	gs_texrender_t *static_layer = nullptr;
+	uint32_t static_cx = 0;
+	uint32_t static_cy = 0;
+	bool static_dirty = true;
+
+	// Input hub -> render thread
+	dz_subscriber input;
+	bool subscribed = false;
+
+	// Timeline storage and analytics (render thread only)
+	dz_timeline timeline;
+
+	// Replay playback position (render thread only)
+	dz_replay_cursor replay;
+	int64_t replay_clock_us = 0;
+
+	// Replay file of the latest snapshot read, holding a reference (UI thread only)
+	dz_replay_file *replay_last = nullptr;
 
 	// bookkeeping
-	uint64_t frame_counter = 0;
+	uint64_t frame_counter = 0; // video frames, however many views render each
+
+	// The video frame the cached layers were built for, and what its later views redraw
+	int64_t frame_time_us = -1;
+	int64_t frame_t_now = 0;
+	bool frame_gpu_quad = false;
+	dz_perf perf;
 };
 
-static inline int vkey_to_row(const dz_source_data *d, uint16_t vkey)
+static inline bool dz_perf_enabled(const dz_settings *s)
 {
-	if (!d)
-		return -1;
-	for (int i = 0; i < ROW_COUNT; i++) {
-		if (d->row_key_vkey[i] == vkey)
-			return i;
+	return s->perf_overlay || s->perf_log;
+}
+
+static void dz_perf_enable(dz_source_data *d, bool enable, int64_t t_now_us);
+static void dz_builder_enable(dz_source_data *d, bool enable);
+
+static void dz_drain_events(dz_source_data *d)
+{
+	// Live input keeps arriving during replay; it is discarded, not applied
+	const bool live = !d->cfg->replay_file;
+	const bool perf = live && dz_perf_enabled(d->cfg);
+	if (perf)
+		d->perf.hists[DZ_PERF_DEPTH].add(d->input.events.size());
+
+	dz_input_event ev;
+	while (d->input.events.pop(ev)) {
+		if (!live)
+			continue;
+		dz_timeline_apply(&d->timeline, d->cfg, ev, nullptr);
+		if (perf && ev.type != DZ_EVENT_MOTION)
+			d->moving.drained_us.push_back(ev.time_us);
 	}
-	return -1;
 }
 
-static float dz_visible_height(const dz_source_data *d);
+// Switches the render thread to a new snapshot; the previous one is freed here,
+// since the render thread is its only reader.
+static void dz_adopt_settings(dz_source_data *d, dz_source_settings *next, int64_t t_now_us)
+{
+	dz_source_settings *prev = d->cfg;
+
+	// Switching between live input and replay starts from an empty timeline and restarts the
+	// replay clock; a re-opened file only needs a fresh seek
+	const bool was_replay = prev && prev->replay_file;
+	const bool switched = was_replay != (next->replay_file != nullptr);
+	if (!prev || switched)
+		d->replay_clock_us = t_now_us;
+	if (!prev || prev->replay_file != next->replay_file)
+		d->replay.valid = false;
+
+	const bool perf_was = prev && dz_perf_enabled(prev);
+	const bool perf_now = dz_perf_enabled(next);
+
+	dz_timeline_adopt(&d->timeline, prev, next, t_now_us);
+	d->input.wants_motion.store(d->timeline.motion.capacity != 0, std::memory_order_relaxed);
+	d->cfg = next;
+	if (prev && switched)
+		dz_timeline_reset(&d->timeline);
+	if (perf_was != perf_now)
+		dz_perf_enable(d, perf_now, t_now_us);
+
+	dz_compute_layout(next, &d->layout);
+	d->static_dirty = true;
+	d->moving_dirty = true;
+	d->events_dirty = true;
+	d->moving.cfg = nullptr; // anything built for prev is stale
+	dz_builder_enable(d, next->async_build);
+	delete prev;
+}
 
 struct dz_key_option {
 	uint16_t vkey;
@@ -200,194 +560,349 @@ static std::string dz_key_title(uint16_t vkey)
 	return title;
 }
 
-static std::string dz_key_label(uint16_t vkey)
+// Short row label (at most 3 characters) written into out
+static void dz_key_label(uint16_t vkey, char (&out)[4])
 {
+	const char *label = nullptr;
+
 	switch (vkey) {
 	case VK_LEFT:
-		return "LFT";
+		label = "LFT";
+		break;
 	case VK_RIGHT:
-		return "RGT";
+		label = "RGT";
+		break;
 	case VK_UP:
-		return "UP";
+		label = "UP";
+		break;
 	case VK_DOWN:
-		return "DWN";
+		label = "DWN";
+		break;
 	case VK_SPACE:
-		return "SPC";
+		label = "SPC";
+		break;
 	case VK_RETURN:
-		return "ENT";
+		label = "ENT";
+		break;
 	case VK_SHIFT:
-		return "SHF";
+		label = "SHF";
+		break;
 	case VK_CONTROL:
-		return "CTL";
+		label = "CTL";
+		break;
 	default:
+		label = dz_key_name(vkey);
 		break;
 	}
 
-	const char *name = dz_key_name(vkey);
-	if (!name)
-		return "UNK";
-
-	const size_t len = strlen(name);
-	if (len <= 3)
-		return name;
+	if (!label)
+		label = "UNK";
 
-	return std::string(name, 3);
+	size_t n = 0;
+	for (; n < 3 && label[n]; n++)
+		out[n] = label[n];
+	out[n] = 0;
 }
 
-// ------------------------------------------------------------
-// Hidden window + RawInput
-static LRESULT CALLBACK dz_wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
+// Fills everything derived from the row key bindings
+static void dz_update_row_keys(dz_settings *s)
 {
-	if (msg == WM_NCCREATE) {
-		auto *cs = (CREATESTRUCTW *)lparam;
-		SetWindowLongPtrW(hwnd, GWLP_USERDATA, (LONG_PTR)cs->lpCreateParams);
-		return DefWindowProcW(hwnd, msg, wparam, lparam);
+	memset(s->vkey_row, -1, sizeof(s->vkey_row));
+
+	// Walk backwards so the first row bound to a key wins
+	for (int i = s->row_count - 1; i >= 0; i--) {
+		dz_key_label(s->row_key_vkey[i], s->row_label[i]);
+		if (s->row_key_vkey[i] < 256)
+			s->vkey_row[s->row_key_vkey[i]] = (int8_t)i;
 	}
+}
 
-	auto *d = (dz_source_data *)GetWindowLongPtrW(hwnd, GWLP_USERDATA);
+// ------------------------------------------------------------
+// Input hub
+// One per module: owns the hidden window, the single raw-input registration and the
+// capture thread that pumps it.  Every record is parsed and timestamped once here and
+// fanned out to each subscribed source's ring.
+enum : UINT {
+	DZ_WM_SUBSCRIBE = WM_APP + 1,   // lparam: dz_subscriber *
+	DZ_WM_UNSUBSCRIBE = WM_APP + 2, // lparam: dz_subscriber *
+};
 
-	switch (msg) {
-	case WM_INPUT: {
-		if (!d)
-			break;
+struct dz_input_hub {
+	std::thread thread;
+	HWND hwnd = nullptr;
+	HANDLE ready = nullptr;
 
-		UINT size = 0;
-		if (GetRawInputData((HRAWINPUT)lparam, RID_INPUT, nullptr, &size, sizeof(RAWINPUTHEADER)) != 0)
-			break;
-		if (size == 0 || size > (1u << 16))
-			break;
+	// Capture thread only
+	dz_capture cap;
+	bool registered = false;
+	bool settle_pending = false; // some key edge is held back by its debounce window
+	HANDLE timer = nullptr;      // wakes the capture loop for work that no input will trigger
+	int64_t timer_due_us = INT64_MAX;
 
-		uint8_t buf[1u << 13]; // 8192
-		if (size > sizeof(buf))
-			break;
+	// Input state (raw)
+	dz_input_state st;
 
-		if (GetRawInputData((HRAWINPUT)lparam, RID_INPUT, buf, &size, sizeof(RAWINPUTHEADER)) != size)
-			break;
+	// Record timing, only taken while some source has instrumentation on
+	std::atomic<int> perf_users{0};
+	dz_perf_hist wndproc_ns;
+};
 
-		const RAWINPUT *ri = (const RAWINPUT *)buf;
+static dz_input_hub g_hub;
 
-		if (ri->header.dwType == RIM_TYPEMOUSE) {
-			const RAWMOUSE &m = ri->data.mouse;
+// Handles one mouse/keyboard record; t is its capture stamp.
+static void dz_handle_rawinput(dz_input_hub *hub, const RAWINPUT *ri, int64_t t)
+{
+	if (ri->header.dwType == RIM_TYPEMOUSE) {
+		const RAWMOUSE &m = ri->data.mouse;
 
-			int dx = (int)m.lLastX;
-			int dy = (int)m.lLastY;
+		int dx = (int)m.lLastX;
+		int dy = (int)m.lLastY;
 
-			d->st.last_dx.store(dx, std::memory_order_relaxed);
-			d->st.last_dy.store(dy, std::memory_order_relaxed);
+		dz_motion_accum &acc = tls_motion;
+		acc.last_dx = dx;
+		acc.last_dy = dy;
+		acc.dx += dx;
+		acc.dy += dy;
+		acc.events++;
 
-			d->st.total_dx.fetch_add(dx, std::memory_order_relaxed);
-			d->st.total_dy.fetch_add(dy, std::memory_order_relaxed);
+		if ((dx || dy) && !(m.usFlags & MOUSE_MOVE_ABSOLUTE))
+			dz_capture_motion(&hub->cap, t, dx, dy);
 
-			d->st.mouse_events.fetch_add(1, std::memory_order_relaxed);
+		USHORT bf = m.usButtonFlags;
 
-			USHORT bf = m.usButtonFlags;
+		// Buttons
+		if (bf & RI_MOUSE_BUTTON_1_DOWN) {
+			hub->st.m1.store(1, std::memory_order_relaxed);
+			dz_capture_click(&hub->cap, t);
+		}
+		if (bf & RI_MOUSE_BUTTON_1_UP)
+			hub->st.m1.store(0, std::memory_order_relaxed);
+		if (bf & RI_MOUSE_BUTTON_2_DOWN)
+			hub->st.m2.store(1, std::memory_order_relaxed);
+		if (bf & RI_MOUSE_BUTTON_2_UP)
+			hub->st.m2.store(0, std::memory_order_relaxed);
+		if (bf & RI_MOUSE_BUTTON_3_DOWN)
+			hub->st.m3.store(1, std::memory_order_relaxed);
+		if (bf & RI_MOUSE_BUTTON_3_UP)
+			hub->st.m3.store(0, std::memory_order_relaxed);
+
+	} else if (ri->header.dwType == RIM_TYPEKEYBOARD) {
+		const RAWKEYBOARD &k = ri->data.keyboard;
+
+		const bool is_break = (k.Flags & RI_KEY_BREAK) != 0;
+		dz_capture_key(&hub->cap, (uint16_t)k.VKey, !is_break, t);
+
+		hub->st.key_events.fetch_add(1, std::memory_order_relaxed);
+	}
+}
 
-			// Buttons
-			if (bf & RI_MOUSE_BUTTON_1_DOWN) {
-				d->st.m1.store(1, std::memory_order_relaxed);
+// Publishes the accumulated motion in one batch of stores
+static void dz_publish_motion(dz_input_hub *hub, int64_t t)
+{
+	dz_motion_accum &acc = tls_motion;
+	acc.published_us = t;
+	if (!acc.events)
+		return;
 
-				// movv.html: left click creates marker and delta from last keydown
-				const int64_t t = now_ms();
+	hub->st.last_dx.store(acc.last_dx, std::memory_order_relaxed);
+	hub->st.last_dy.store(acc.last_dy, std::memory_order_relaxed);
+	hub->st.total_dx.fetch_add(acc.dx, std::memory_order_relaxed);
+	hub->st.total_dy.fetch_add(acc.dy, std::memory_order_relaxed);
+	hub->st.mouse_events.fetch_add(acc.events, std::memory_order_relaxed);
+	acc.dx = acc.dy = 0;
+	acc.events = 0;
+}
 
-				int row = ROW_D;
-				int delta = 0;
+// Arms the hub timer for the earliest of: the end of the open motion bin, the end of the
+// motion publish period and the next settle check, so a movement that stops or a key
+// release held back by debounce still goes out without waiting for more input.
+static void dz_hub_arm(dz_input_hub *hub, int64_t t)
+{
+	int64_t due = INT64_MAX;
+	if (hub->cap.motion_bin_us >= 0)
+		due = std::min(due, hub->cap.motion_bin_us + DZ_MOTION_BIN_US);
+	if (tls_motion.events)
+		due = std::min(due, tls_motion.published_us + DZ_MOTION_PUBLISH_US);
+	if (hub->settle_pending)
+		due = std::min(due, t + 1000);
+
+	if (!hub->timer || due == hub->timer_due_us)
+		return;
 
-				if (d->last_key_valid.load(std::memory_order_relaxed) != 0) {
-					row = d->last_key_row.load(std::memory_order_relaxed);
-					const int64_t lk = d->last_key_down_ms.load(std::memory_order_relaxed);
-					const int64_t raw_delta = t - lk;
-					delta = (raw_delta > 0) ? (int)raw_delta : 0;
-				}
+	hub->timer_due_us = due;
+	if (due == INT64_MAX) {
+		CancelWaitableTimer(hub->timer);
+		return;
+	}
 
-				d->clicks.push_back({row, t, delta});
-			}
-			if (bf & RI_MOUSE_BUTTON_1_UP)
-				d->st.m1.store(0, std::memory_order_relaxed);
-			if (bf & RI_MOUSE_BUTTON_2_DOWN)
-				d->st.m2.store(1, std::memory_order_relaxed);
-			if (bf & RI_MOUSE_BUTTON_2_UP)
-				d->st.m2.store(0, std::memory_order_relaxed);
-			if (bf & RI_MOUSE_BUTTON_3_DOWN)
-				d->st.m3.store(1, std::memory_order_relaxed);
-			if (bf & RI_MOUSE_BUTTON_3_UP)
-				d->st.m3.store(0, std::memory_order_relaxed);
-
-		} else if (ri->header.dwType == RIM_TYPEKEYBOARD) {
-			const RAWKEYBOARD &k = ri->data.keyboard;
-
-			const bool is_break = (k.Flags & RI_KEY_BREAK) != 0;
-			const uint16_t vkey = (uint16_t)k.VKey;
-
-			const int row = vkey_to_row(d, vkey);
-			bool was_down = false;
-			if (row != -1) {
-				was_down = d->st.key_down[row].load(std::memory_order_relaxed) != 0;
-				d->st.key_down[row].store(is_break ? 0 : 1, std::memory_order_relaxed);
-			}
+	LARGE_INTEGER rel;
+	rel.QuadPart = -std::max<int64_t>(1, (due - now_us()) * 10); // relative, in 100 ns units
+	SetWaitableTimer(hub->timer, &rel, 0, nullptr, nullptr, FALSE);
+}
 
-			// Timeline segments: only the 4 configured keys
-			if (row != -1) {
-				const int64_t t = now_ms();
-
-				if (!is_break) {
-					// keydown (ignore repeats when already pressed)
-					bool already = was_down;
-
-					// Start a segment only if there is no open one for this row.
-					bool has_open = false;
-					for (auto it = d->segments.rbegin(); it != d->segments.rend(); ++it) {
-						if (it->row == row && it->end_ms < 0) {
-							has_open = true;
-							break;
-						}
-					}
-					if (!already && !has_open) {
-						d->segments.push_back({row, t, -1});
-						d->last_key_row.store(row, std::memory_order_relaxed);
-						d->last_key_down_ms.store(t, std::memory_order_relaxed);
-						d->last_key_valid.store(1, std::memory_order_relaxed);
-					}
-				} else {
-					// keyup: close the latest open segment for this row
-					for (auto it = d->segments.rbegin(); it != d->segments.rend(); ++it) {
-						if (it->row == row && it->end_ms < 0) {
-							it->end_ms = t;
-							break;
-						}
-					}
-				}
-			}
+// Publishes the key edges whose debounce window has closed
+static void dz_settle_keys(dz_input_hub *hub, int64_t t)
+{
+	hub->settle_pending = dz_capture_settle(&hub->cap, t);
+}
 
-			d->st.key_events.fetch_add(1, std::memory_order_relaxed);
-		}
+// Called after each WM_INPUT: publishes once the period is up, otherwise leaves the
+// remainder to the hub timer in case the mouse stops moving
+static void dz_maybe_publish_motion(dz_input_hub *hub, int64_t t)
+{
+	if (tls_motion.events && t - tls_motion.published_us >= DZ_MOTION_PUBLISH_US)
+		dz_publish_motion(hub, t);
+}
 
-		break;
-	}
-	default:
-		break;
-	}
+// Hub timer fired: does whatever came due and arms it for the next deadline
+static void dz_hub_tick(dz_input_hub *hub, int64_t t)
+{
+	hub->timer_due_us = INT64_MAX;
+	if (hub->cap.motion_bin_us >= 0 && hub->cap.motion_bin_us + DZ_MOTION_BIN_US <= t)
+		dz_capture_flush_motion(&hub->cap);
+	dz_maybe_publish_motion(hub, t);
+	if (hub->settle_pending)
+		dz_settle_keys(hub, t);
+	dz_hub_arm(hub, t);
+}
 
-	return DefWindowProcW(hwnd, msg, wparam, lparam);
+// Drains whatever raw input is still queued for this thread in batches, so a burst
+// from a high polling rate mouse costs one GetRawInputBuffer call per batch instead
+// of one WM_INPUT dispatch and two GetRawInputData calls per record.
+//
+// Raw input carries no timestamps of its own. A batch holds records that arrived after
+// the previous stamp (t, the dequeue of the WM_INPUT that started the drain, for the first
+// batch) and before the QPC read right after the call, so its records are spread evenly
+// over that span, in queue order. A stamp is off by at most the span of its batch, which
+// is how long the queue went unread: well under a millisecond while the thread keeps up.
+// t is moved on to the last stamp handed out.
+static uint32_t dz_drain_rawinput_buffer(dz_input_hub *hub, int64_t *t)
+{
+	alignas(8) static uint8_t buf[1u << 14]; // capture thread only
+	uint32_t handled = 0;
+	int64_t lo = *t;
+
+	for (;;) {
+		UINT size = sizeof(buf);
+		const UINT count = GetRawInputBuffer((PRAWINPUT)buf, &size, sizeof(RAWINPUTHEADER));
+		if (count == 0 || count == (UINT)-1)
+			break;
+
+		const int64_t hi = std::max(lo, now_us());
+		PRAWINPUT ri = (PRAWINPUT)buf;
+		for (UINT i = 0; i < count; i++) {
+			dz_handle_rawinput(hub, ri, lo + (hi - lo) * (int64_t)(i + 1) / (int64_t)count);
+			ri = NEXTRAWINPUTBLOCK(ri);
+		}
+		handled += count;
+		lo = hi;
+	}
+	*t = lo;
+	return handled;
 }
 
-static bool dz_register_rawinput(HWND hwnd)
+static bool dz_register_rawinput(HWND hwnd, bool enable)
 {
 	RAWINPUTDEVICE rid[2]{};
 
 	rid[0].usUsagePage = HID_USAGE_PAGE_GENERIC;
 	rid[0].usUsage = HID_USAGE_GENERIC_MOUSE;
-	rid[0].dwFlags = RIDEV_INPUTSINK;
-	rid[0].hwndTarget = hwnd;
+	rid[0].dwFlags = enable ? RIDEV_INPUTSINK : RIDEV_REMOVE;
+	rid[0].hwndTarget = enable ? hwnd : nullptr;
 
 	rid[1].usUsagePage = HID_USAGE_PAGE_GENERIC;
 	rid[1].usUsage = HID_USAGE_GENERIC_KEYBOARD;
-	rid[1].dwFlags = RIDEV_INPUTSINK;
-	rid[1].hwndTarget = hwnd;
+	rid[1].dwFlags = enable ? RIDEV_INPUTSINK : RIDEV_REMOVE;
+	rid[1].hwndTarget = enable ? hwnd : nullptr;
 
 	return RegisterRawInputDevices(rid, 2, sizeof(rid[0])) == TRUE;
 }
 
-static HWND dz_create_hidden_window(dz_source_data *d)
+// The subscriber list doubles as the registration refcount: raw input is only
+// registered while at least one source is listening.
+static LRESULT dz_hub_subscribe(dz_input_hub *hub, dz_subscriber *sub)
+{
+	if (!hub->registered) {
+		if (!dz_register_rawinput(hub->hwnd, true))
+			return FALSE;
+		hub->registered = true;
+	}
+
+	hub->cap.subscribers.push_back(sub);
+	return TRUE;
+}
+
+static void dz_hub_unsubscribe(dz_input_hub *hub, dz_subscriber *sub)
+{
+	std::vector<dz_subscriber *> &subs = hub->cap.subscribers;
+	auto it = std::find(subs.begin(), subs.end(), sub);
+	if (it != subs.end())
+		subs.erase(it);
+
+	if (subs.empty() && hub->registered) {
+		dz_register_rawinput(hub->hwnd, false);
+		hub->registered = false;
+	}
+}
+
+// ------------------------------------------------------------
+// Hidden window + RawInput (capture thread)
+static LRESULT CALLBACK dz_wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
+{
+	dz_input_hub *hub = &g_hub;
+
+	switch (msg) {
+	case WM_INPUT: {
+		const int64_t t = dz_input_time_us();
+		const bool timed = hub->perf_users.load(std::memory_order_relaxed) > 0;
+		const uint64_t start_ns = timed ? os_gettime_ns() : 0;
+		uint32_t handled = 0;
+
+		// Mouse and keyboard records always fit in a RAWINPUT, so skip the size probe.
+		RAWINPUT ri;
+		UINT size = sizeof(ri);
+		if (GetRawInputData((HRAWINPUT)lparam, RID_INPUT, &ri, &size, sizeof(RAWINPUTHEADER)) != (UINT)-1) {
+			dz_handle_rawinput(hub, &ri, t);
+			handled++;
+		}
+
+		int64_t t_last = t;
+		handled += dz_drain_rawinput_buffer(hub, &t_last);
+		dz_settle_keys(hub, t_last);
+		dz_maybe_publish_motion(hub, t_last);
+		dz_hub_arm(hub, t_last);
+		if (timed && handled)
+			hub->wndproc_ns.add((os_gettime_ns() - start_ns) / handled);
+		break;
+	}
+	case DZ_WM_SUBSCRIBE:
+		return dz_hub_subscribe(hub, (dz_subscriber *)lparam);
+	case DZ_WM_UNSUBSCRIBE:
+		dz_hub_unsubscribe(hub, (dz_subscriber *)lparam);
+		return 0;
+	case WM_CLOSE:
+		dz_capture_flush_motion(&hub->cap);
+		dz_publish_motion(hub, now_us());
+		hub->settle_pending = false;
+		dz_hub_arm(hub, now_us());
+		if (hub->registered) {
+			dz_register_rawinput(hwnd, false);
+			hub->registered = false;
+		}
+		hub->cap.subscribers.clear();
+		DestroyWindow(hwnd);
+		return 0;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		return 0;
+	default:
+		break;
+	}
+
+	return DefWindowProcW(hwnd, msg, wparam, lparam);
+}
+
+static HWND dz_create_hidden_window()
 {
 	WNDCLASSEXW wc{};
 	wc.cbSize = sizeof(wc);
@@ -401,222 +916,1084 @@ static HWND dz_create_hidden_window(dz_source_data *d)
 	}
 
 	HWND hwnd = CreateWindowExW(0, kWndClass, L"DZ Input Analyzer Hidden", WS_OVERLAPPEDWINDOW, 0, 0, 100, 100,
-				    nullptr, nullptr, GetModuleHandleW(nullptr), d);
+				    nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
 
 	if (!hwnd)
 		return nullptr;
 
 	ShowWindow(hwnd, SW_HIDE);
-	if (!dz_register_rawinput(hwnd)) {
-		DestroyWindow(hwnd);
+	return hwnd;
+}
+
+// Capture thread: pumps the hub window with our own high-priority message loop
+// instead of whichever thread created the source, and waits on the hub timer too.
+//
+// The timer is a high resolution waitable timer (Windows 10 1803 and later) since
+// SetTimer rounds anything under the system tick up to about 15.6 ms. Older systems
+// get a plain waitable timer, which fires on that tick unless something has raised
+// the timer resolution.
+static void dz_hub_main()
+{
+	os_set_thread_name("dz-input-analyzer: capture");
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+	g_hub.timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!g_hub.timer)
+		g_hub.timer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+	if (!g_hub.timer)
+		blog(LOG_WARNING, "[dz-input-analyzer] No capture timer, idle motion and settled keys wait for input");
+
+	g_hub.hwnd = dz_create_hidden_window();
+	SetEvent(g_hub.ready);
+
+	bool quit = !g_hub.hwnd;
+	while (!quit) {
+		const DWORD waits = g_hub.timer ? 1 : 0;
+		const DWORD r = MsgWaitForMultipleObjectsEx(waits, &g_hub.timer, INFINITE, QS_ALLINPUT,
+							    MWMO_INPUTAVAILABLE);
+		if (r == WAIT_FAILED)
+			break;
+		if (waits && r == WAIT_OBJECT_0) {
+			tls_msg_time_us = now_us();
+			dz_hub_tick(&g_hub, tls_msg_time_us);
+			continue;
+		}
+
+		MSG msg;
+		while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) {
+				quit = true;
+				break;
+			}
+			tls_msg_time_us = now_us();
+			DispatchMessageW(&msg);
+		}
+	}
+
+	if (g_hub.timer) {
+		CloseHandle(g_hub.timer);
+		g_hub.timer = nullptr;
+	}
+	g_hub.timer_due_us = INT64_MAX;
+}
+
+static bool dz_hub_start()
+{
+	g_hub.ready = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (!g_hub.ready)
+		return false;
+
+	g_hub.thread = std::thread(dz_hub_main);
+	WaitForSingleObject(g_hub.ready, INFINITE);
+	CloseHandle(g_hub.ready);
+	g_hub.ready = nullptr;
+
+	return g_hub.hwnd != nullptr;
+}
+
+static void dz_hub_stop()
+{
+	if (g_hub.hwnd)
+		PostMessageW(g_hub.hwnd, WM_CLOSE, 0, 0);
+	if (g_hub.thread.joinable())
+		g_hub.thread.join();
+	g_hub.hwnd = nullptr;
+}
+
+// Both block until the capture thread has updated its subscriber list, so once
+// detach returns the hub no longer touches the ring.
+static bool dz_hub_attach(dz_subscriber *sub)
+{
+	if (!g_hub.hwnd)
+		return false;
+	return SendMessageW(g_hub.hwnd, DZ_WM_SUBSCRIBE, 0, (LPARAM)sub) == TRUE;
+}
+
+static void dz_hub_detach(dz_subscriber *sub)
+{
+	if (g_hub.hwnd)
+		SendMessageW(g_hub.hwnd, DZ_WM_UNSUBSCRIBE, 0, (LPARAM)sub);
+}
+
+static const dz_perf_hist &dz_perf_hist_of(const dz_source_data *d, int m)
+{
+	return m == DZ_PERF_WNDPROC ? g_hub.wndproc_ns : d->perf.hists[m];
+}
+
+// Starts both periods from now, so the first summary only covers time with
+// instrumentation on; the hub only times records while someone is listening.
+static void dz_perf_enable(dz_source_data *d, bool enable, int64_t t_now_us)
+{
+	g_hub.perf_users.fetch_add(enable ? 1 : -1, std::memory_order_relaxed);
+	if (!enable)
+		return;
+
+	dz_perf &p = d->perf;
+	for (int m = 0; m < DZ_PERF_METRICS; m++) {
+		dz_perf_take(dz_perf_hist_of(d, m), &p.marks[m].overlay);
+		p.marks[m].log = p.marks[m].overlay;
+		p.overlay[m] = dz_perf_summary();
+	}
+	p.log_dropped = d->input.dropped_events.load(std::memory_order_relaxed);
+	p.log_mouse = g_hub.st.mouse_events.load(std::memory_order_relaxed);
+	p.log_keys = g_hub.st.key_events.load(std::memory_order_relaxed);
+	p.log_frames = p.frames;
+	p.max_rects = 0;
+	p.label[0][0] = p.label[1][0] = p.label[2][0] = 0;
+	p.overlay_due_us = t_now_us + DZ_PERF_OVERLAY_US;
+	p.log_due_us = t_now_us + DZ_PERF_LOG_US;
+	p.drained_us.clear();
+	p.drained_us.reserve(256);
+	d->moving.drained_us.clear();
+	d->moving.drained_us.reserve(256);
+}
+
+static void dz_perf_log(dz_source_data *d)
+{
+	dz_perf &p = d->perf;
+
+	dz_perf_summary s[DZ_PERF_METRICS];
+	for (int m = 0; m < DZ_PERF_METRICS; m++) {
+		dz_perf_snapshot now;
+		dz_perf_take(dz_perf_hist_of(d, m), &now);
+		s[m] = dz_perf_summarize(now, p.marks[m].log);
+		p.marks[m].log = now;
+	}
+
+	const uint32_t dropped = d->input.dropped_events.load(std::memory_order_relaxed);
+	const uint32_t mouse = g_hub.st.mouse_events.load(std::memory_order_relaxed);
+	const uint32_t keys = g_hub.st.key_events.load(std::memory_order_relaxed);
+
+	blog(LOG_INFO,
+	     "[dz-input-analyzer] perf: %u frames, render p50 %.1f p99 %.1f us, wndproc p50 %.2f p99 %.2f us/record, "
+	     "latency p50 %.2f p99 %.2f ms (%u events), queue p50 %.0f p99 %.0f, dropped %u, "
+	     "raw mouse %u key %u, %u draws %u rects (max %u)",
+	     p.frames - p.log_frames, s[DZ_PERF_RENDER].p50 / 1000.0, s[DZ_PERF_RENDER].p99 / 1000.0,
+	     s[DZ_PERF_WNDPROC].p50 / 1000.0, s[DZ_PERF_WNDPROC].p99 / 1000.0, s[DZ_PERF_LATENCY].p50 / 1e6,
+	     s[DZ_PERF_LATENCY].p99 / 1e6, s[DZ_PERF_LATENCY].count, s[DZ_PERF_DEPTH].p50, s[DZ_PERF_DEPTH].p99,
+	     dropped - p.log_dropped, mouse - p.log_mouse, keys - p.log_keys, p.draws, p.rects, p.max_rects);
+
+	p.log_dropped = dropped;
+	p.log_mouse = mouse;
+	p.log_keys = keys;
+	p.log_frames = p.frames;
+	p.max_rects = 0;
+}
+
+static void dz_perf_refresh_overlay(dz_source_data *d)
+{
+	dz_perf &p = d->perf;
+	for (int m = 0; m < DZ_PERF_METRICS; m++) {
+		dz_perf_snapshot now;
+		dz_perf_take(dz_perf_hist_of(d, m), &now);
+		p.overlay[m] = dz_perf_summarize(now, p.marks[m].overlay);
+		p.marks[m].overlay = now;
+	}
+
+	const dz_perf_summary *o = p.overlay;
+	_snprintf_s(p.label[0], _TRUNCATE, "CPU P50 %.0f P99 %.0f US   DRAW %u RECT %u", o[DZ_PERF_RENDER].p50 / 1000.0,
+		    o[DZ_PERF_RENDER].p99 / 1000.0, p.draws, p.rects);
+	_snprintf_s(p.label[1], _TRUNCATE, "LAT P50 %.1f P99 %.1f MS   N %u", o[DZ_PERF_LATENCY].p50 / 1e6,
+		    o[DZ_PERF_LATENCY].p99 / 1e6, o[DZ_PERF_LATENCY].count);
+	_snprintf_s(p.label[2], _TRUNCATE, "WND P50 %.2f P99 %.2f US   Q P99 %.0f   DROP %u",
+		    o[DZ_PERF_WNDPROC].p50 / 1000.0, o[DZ_PERF_WNDPROC].p99 / 1000.0, o[DZ_PERF_DEPTH].p99,
+		    d->input.dropped_events.load(std::memory_order_relaxed));
+}
+
+// Closes the frame's measurements: render time, latency of what was drawn, and the periods
+static void dz_perf_end_frame(dz_source_data *d, uint64_t start_ns)
+{
+	dz_perf &p = d->perf;
+	const int64_t t_end_us = now_us();
+
+	for (int64_t t : p.drained_us)
+		p.hists[DZ_PERF_LATENCY].add((uint64_t)std::max<int64_t>(0, t_end_us - t) * 1000);
+	p.drained_us.clear();
+
+	p.frames++;
+	p.max_rects = std::max(p.max_rects, p.rects);
+	p.hists[DZ_PERF_RENDER].add(os_gettime_ns() - start_ns);
+
+	if (t_end_us >= p.overlay_due_us) {
+		p.overlay_due_us = t_end_us + DZ_PERF_OVERLAY_US;
+		if (d->cfg->perf_overlay) {
+			dz_perf_refresh_overlay(d);
+			d->moving_dirty = true;
+		}
+	}
+	if (t_end_us >= p.log_due_us) {
+		p.log_due_us = t_end_us + DZ_PERF_LOG_US;
+		if (d->cfg->perf_log)
+			dz_perf_log(d);
+	}
+}
+
+// ------------------------------------------------------------
+// Session recorder (writer thread)
+//
+// File layout, all little-endian, in fixed 64 KiB pages:
+//   page 0   dz_rec_file_header, rest zero
+//   page 1+  dz_rec_page_header followed by up to DZ_REC_RECORDS_PER_PAGE records
+// Record times are deltas from the page base, so pages can be searched independently.
+static constexpr uint32_t DZ_REC_FILE_MAGIC = 0x46525a44; // "DZRF"
+static constexpr uint32_t DZ_REC_PAGE_MAGIC = 0x47505a44; // "DZPG"
+static constexpr uint32_t DZ_REC_VERSION = 1;
+static constexpr uint32_t DZ_REC_PAGE_SIZE = 1u << 16;
+
+struct dz_rec_file_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t page_size;
+	uint32_t record_size;
+	int64_t start_us; // capture clock when recording started
+	int64_t reserved;
+};
+
+struct dz_rec_page_header {
+	uint32_t magic;
+	uint32_t count; // records in this page
+	int64_t base_us; // time of the first record
+	int64_t last_us; // time of the last record
+	int64_t reserved;
+};
+
+struct dz_rec_record {
+	uint32_t delta_us; // from dz_rec_page_header::base_us
+	uint8_t type;      // dz_event_type
+	uint8_t reserved;
+	uint16_t vkey;
+	uint32_t value;
+};
+
+static_assert(sizeof(dz_rec_record) == 12, "record layout is part of the file format");
+static_assert(sizeof(dz_rec_page_header) == 32, "page header layout is part of the file format");
+
+static constexpr uint32_t DZ_REC_RECORDS_PER_PAGE =
+	(DZ_REC_PAGE_SIZE - (uint32_t)sizeof(dz_rec_page_header)) / (uint32_t)sizeof(dz_rec_record);
+
+struct dz_rec_page {
+	alignas(64) uint8_t bytes[DZ_REC_PAGE_SIZE];
+	OVERLAPPED ov;
+	bool pending = false; // write in flight
+
+	dz_rec_page_header *header() { return (dz_rec_page_header *)bytes; }
+	dz_rec_record *records() { return (dz_rec_record *)(bytes + sizeof(dz_rec_page_header)); }
+};
+
+struct dz_recorder {
+	// Control: start/stop come from the hotkey, frontend and UI threads
+	std::mutex lock;
+	bool active = false;
+	std::string dir;       // from settings, empty = module config dir
+	bool with_obs = false; // follow OBS recording start/stop
+
+	// Hub -> writer thread
+	dz_subscriber input;
+	std::thread thread;
+	std::atomic<bool> stop{false};
+
+	// Writer thread only
+	HANDLE file = INVALID_HANDLE_VALUE;
+	dz_rec_page *pages = nullptr; // two, one filling while the other is written
+	int cur = 0;
+	uint64_t offset = 0; // file offset of the next page
+	uint64_t pages_written = 0;
+	uint64_t events_written = 0;
+	uint32_t write_errors = 0;
+};
+
+static void dz_rec_wait(dz_recorder *r, dz_rec_page *pg)
+{
+	if (!pg->pending)
+		return;
+	DWORD n = 0;
+	if (!GetOverlappedResult(r->file, &pg->ov, &n, TRUE) || n != DZ_REC_PAGE_SIZE)
+		r->write_errors++;
+	pg->pending = false;
+}
+
+// Starts an asynchronous write of the current page and switches to the other one,
+// which is only reused once its previous write has completed.
+static void dz_rec_submit(dz_recorder *r)
+{
+	dz_rec_page *pg = &r->pages[r->cur];
+
+	HANDLE ev = pg->ov.hEvent;
+	memset(&pg->ov, 0, sizeof(pg->ov));
+	pg->ov.hEvent = ev;
+	pg->ov.Offset = (DWORD)(r->offset & 0xFFFFFFFFu);
+	pg->ov.OffsetHigh = (DWORD)(r->offset >> 32);
+
+	if (WriteFile(r->file, pg->bytes, DZ_REC_PAGE_SIZE, nullptr, &pg->ov) || GetLastError() == ERROR_IO_PENDING)
+		pg->pending = true;
+	else
+		r->write_errors++;
+
+	r->offset += DZ_REC_PAGE_SIZE;
+	r->pages_written++;
+
+	r->cur ^= 1;
+	dz_rec_page *next = &r->pages[r->cur];
+	dz_rec_wait(r, next);
+	memset(next->bytes, 0, sizeof(dz_rec_page_header));
+	next->header()->magic = DZ_REC_PAGE_MAGIC;
+}
+
+static void dz_rec_append(dz_recorder *r, const dz_input_event &ev)
+{
+	dz_rec_page_header *h = r->pages[r->cur].header();
+	if (h->count && (h->count == DZ_REC_RECORDS_PER_PAGE || ev.time_us - h->base_us > (int64_t)UINT32_MAX)) {
+		dz_rec_submit(r);
+		h = r->pages[r->cur].header();
+	}
+
+	if (!h->count)
+		h->base_us = ev.time_us;
+
+	dz_rec_record &rec = r->pages[r->cur].records()[h->count++];
+	rec.delta_us = (uint32_t)std::max<int64_t>(0, ev.time_us - h->base_us);
+	rec.type = ev.type;
+	rec.reserved = 0;
+	rec.vkey = ev.vkey;
+	rec.value = ev.value;
+	h->last_us = std::max(h->last_us, ev.time_us);
+	r->events_written++;
+}
+
+static void dz_rec_main(dz_recorder *r, int64_t start_us)
+{
+	os_set_thread_name("dz-input-analyzer: recorder");
+
+	// Page 0 is the file header
+	dz_rec_page *pg = &r->pages[r->cur];
+	memset(pg->bytes, 0, DZ_REC_PAGE_SIZE);
+	auto *fh = (dz_rec_file_header *)pg->bytes;
+	fh->magic = DZ_REC_FILE_MAGIC;
+	fh->version = DZ_REC_VERSION;
+	fh->page_size = DZ_REC_PAGE_SIZE;
+	fh->record_size = sizeof(dz_rec_record);
+	fh->start_us = start_us;
+	dz_rec_submit(r);
+
+	// Records arrive at most a few thousand per second, so polling keeps the
+	// capture thread free of any wakeup calls.
+	for (;;) {
+		const bool stopping = r->stop.load(std::memory_order_acquire);
+
+		dz_input_event ev;
+		while (r->input.events.pop(ev))
+			dz_rec_append(r, ev);
+
+		if (stopping)
+			break;
+		os_sleep_ms(10);
+	}
+
+	if (r->pages[r->cur].header()->count)
+		dz_rec_submit(r);
+	dz_rec_wait(r, &r->pages[0]);
+	dz_rec_wait(r, &r->pages[1]);
+}
+
+// Session files are named after the local start time to the millisecond. Every source
+// records on its own, so sources started together (or a quick stop/start) take the next
+// free -N suffix instead of failing on the name already taken.
+static bool dz_recorder_open(dz_recorder *r, const char *dir)
+{
+	if (os_mkdirs(dir) == MKDIR_ERROR)
+		return false;
+
+	SYSTEMTIME st;
+	GetLocalTime(&st);
+
+	char path[MAX_PATH];
+	for (int n = 1; n <= 64; n++) {
+		char suffix[8] = "";
+		if (n > 1)
+			_snprintf_s(suffix, _TRUNCATE, "-%d", n);
+		_snprintf_s(path, _TRUNCATE, "%s/dz-session-%04u%02u%02u-%02u%02u%02u-%03u%s.dzrec", dir,
+			    (unsigned)st.wYear, (unsigned)st.wMonth, (unsigned)st.wDay, (unsigned)st.wHour,
+			    (unsigned)st.wMinute, (unsigned)st.wSecond, (unsigned)st.wMilliseconds, suffix);
+
+		wchar_t wpath[MAX_PATH];
+		if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH))
+			return false;
+
+		const DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+		r->file = CreateFileW(wpath, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_NEW, flags, nullptr);
+		if (r->file != INVALID_HANDLE_VALUE)
+			break;
+		if (GetLastError() != ERROR_FILE_EXISTS)
+			return false;
+	}
+	if (r->file == INVALID_HANDLE_VALUE)
+		return false;
+
+	blog(LOG_INFO, "[dz-input-analyzer] recording to %s", path);
+	return true;
+}
+
+static void dz_recorder_close(dz_recorder *r)
+{
+	if (r->pages) {
+		for (int i = 0; i < 2; i++) {
+			if (r->pages[i].ov.hEvent)
+				CloseHandle(r->pages[i].ov.hEvent);
+		}
+		delete[] r->pages;
+		r->pages = nullptr;
+	}
+	if (r->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(r->file);
+		r->file = INVALID_HANDLE_VALUE;
+	}
+}
+
+static void dz_recorder_start(dz_recorder *r)
+{
+	std::lock_guard<std::mutex> guard(r->lock);
+	if (r->active)
+		return;
+
+	std::string dir = r->dir;
+	if (dir.empty()) {
+		char *config_dir = obs_module_config_path("sessions");
+		if (config_dir)
+			dir = config_dir;
+		bfree(config_dir);
+	}
+
+	if (!dz_recorder_open(r, dir.c_str())) {
+		blog(LOG_WARNING, "[dz-input-analyzer] cannot create a session file in '%s'", dir.c_str());
+		return;
+	}
+
+	r->pages = new dz_rec_page[2];
+	for (int i = 0; i < 2; i++) {
+		r->pages[i].ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		r->pages[i].header()->magic = DZ_REC_PAGE_MAGIC;
+	}
+	r->cur = 0;
+	r->offset = 0;
+	r->pages_written = 0;
+	r->events_written = 0;
+	r->write_errors = 0;
+	r->input.dropped_events.store(0, std::memory_order_relaxed);
+	r->input.wants_motion.store(true, std::memory_order_relaxed);
+	r->stop.store(false, std::memory_order_relaxed);
+
+	r->thread = std::thread(dz_rec_main, r, now_us());
+	if (!dz_hub_attach(&r->input))
+		blog(LOG_WARNING, "[dz-input-analyzer] recorder could not attach to the input hub");
+	r->active = true;
+}
+
+static void dz_recorder_stop(dz_recorder *r)
+{
+	std::lock_guard<std::mutex> guard(r->lock);
+	if (!r->active)
+		return;
+
+	// Once detached the hub no longer produces into the ring; the writer drains the rest
+	dz_hub_detach(&r->input);
+	r->stop.store(true, std::memory_order_release);
+	if (r->thread.joinable())
+		r->thread.join();
+
+	blog(LOG_INFO, "[dz-input-analyzer] recording stopped: %llu events, %llu pages, %u dropped, %u write errors",
+	     (unsigned long long)r->events_written, (unsigned long long)r->pages_written,
+	     r->input.dropped_events.load(std::memory_order_relaxed), r->write_errors);
+
+	dz_recorder_close(r);
+	r->active = false;
+}
+
+static void dz_recorder_toggle(dz_recorder *r)
+{
+	bool active;
+	{
+		std::lock_guard<std::mutex> guard(r->lock);
+		active = r->active;
+	}
+	if (active)
+		dz_recorder_stop(r);
+	else
+		dz_recorder_start(r);
+}
+
+static void dz_recorder_configure(dz_recorder *r, const char *dir, bool with_obs)
+{
+	std::lock_guard<std::mutex> guard(r->lock);
+	r->dir = dir ? dir : "";
+	r->with_obs = with_obs;
+}
+
+// ------------------------------------------------------------
+// Live telemetry (export thread)
+//
+// Key presses, releases and clicks, with the rows, deltas and counter-strafe measurements
+// the overlay shows, go into a named shared-memory ring ("Local\<telemetry name>") for
+// external dashboards. The export has its own hub subscriber and timeline, so it runs at
+// input rate whether or not the source is rendered, and the capture thread only ever
+// pushes into its ring: if the exporter falls behind, events are dropped there and counted.
+//
+// Layout: dz_tel_header, then DZ_TEL_CAPACITY records; record n is in slot n % capacity.
+// One writer, any number of readers that never write to the mapping. A reader keeps its own
+// cursor n < head and reads a record's seq before and after copying it: n + 1 both times
+// means the copy is intact, anything else means it was lapped and should skip ahead to
+// head - capacity.
+static constexpr uint32_t DZ_TEL_MAGIC = 0x4c545a44; // "DZTL"
+static constexpr uint32_t DZ_TEL_VERSION = 1;
+static constexpr uint32_t DZ_TEL_CAPACITY = 4096;
+
+enum dz_tel_type : uint8_t {
+	DZ_TEL_KEY_DOWN = 1, // value: 0
+	DZ_TEL_KEY_UP = 2,   // value: time held
+	DZ_TEL_CLICK = 3,    // value: delta from the last key press
+	DZ_TEL_STRAFE = 4,   // value: counter-strafe gap (> 0) or overlap (< 0), at the key event
+	DZ_TEL_SHOT = 5,     // value: first click after a counter-strafe, from the stop
+};
+
+struct dz_tel_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t capacity;
+	int64_t start_us; // capture clock (us, QPC based) when the export started
+	uint8_t reserved[40];
+
+	// Written by the exporter only
+	std::atomic<uint64_t> head;    // records written
+	std::atomic<uint64_t> dropped; // events lost before the ring, exporter behind capture
+	uint8_t reserved2[48];
+};
+
+struct dz_tel_record {
+	std::atomic<uint64_t> seq; // n + 1 once record n is complete, 0 while it is written
+	int64_t time_us;           // capture clock
+	int64_t value_us;          // see dz_tel_type
+	uint8_t type;              // dz_tel_type
+	int8_t row;
+	uint16_t vkey;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(dz_tel_header) == 128, "header layout is read by external tools");
+static_assert(sizeof(dz_tel_record) == 32, "record layout is read by external tools");
+
+struct dz_telemetry {
+	// Control: configured from the UI thread
+	std::mutex lock;
+	bool active = false;
+	std::string name;
+
+	// Hub -> export thread, and the row bindings from the UI thread
+	dz_subscriber input;
+	std::thread thread;
+	std::atomic<bool> stop{false};
+	std::atomic<dz_settings *> pending{nullptr};
+
+	// Export thread only
+	HANDLE mapping = nullptr;
+	dz_tel_header *header = nullptr;
+	dz_tel_record *records = nullptr;
+	dz_settings *cfg = nullptr;
+	dz_timeline timeline;
+	uint64_t written = 0;
+};
+
+static void dz_tel_push(dz_telemetry *t, dz_tel_type type, const dz_input_event &ev, int row, int64_t value_us)
+{
+	const uint64_t n = t->written++;
+	dz_tel_record &rec = t->records[n & (DZ_TEL_CAPACITY - 1)];
+	rec.seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	rec.time_us = ev.time_us;
+	rec.value_us = value_us;
+	rec.type = type;
+	rec.row = (int8_t)row;
+	rec.vkey = ev.vkey;
+	rec.reserved = 0;
+	rec.seq.store(n + 1, std::memory_order_release);
+	t->header->head.store(n + 1, std::memory_order_release);
+}
+
+static void dz_tel_apply(dz_telemetry *t, const dz_input_event &ev)
+{
+	dz_applied a;
+	dz_timeline_apply(&t->timeline, t->cfg, ev, &a);
+	if (a.row < 0)
+		return;
+
+	if (ev.type == DZ_EVENT_CLICK)
+		dz_tel_push(t, DZ_TEL_CLICK, ev, a.row, a.value_us);
+	else
+		dz_tel_push(t, ev.type == DZ_EVENT_KEY_DOWN ? DZ_TEL_KEY_DOWN : DZ_TEL_KEY_UP, ev, a.row, a.value_us);
+	if (a.strafe_us != INT64_MIN)
+		dz_tel_push(t, DZ_TEL_STRAFE, ev, a.row, a.strafe_us);
+	if (a.shot_us >= 0)
+		dz_tel_push(t, DZ_TEL_SHOT, ev, a.row, a.shot_us);
+}
+
+static void dz_tel_main(dz_telemetry *t)
+{
+	os_set_thread_name("dz-input-analyzer: telemetry");
+
+	// Polled like the recorder, but every millisecond: dashboards want the events live
+	for (;;) {
+		const bool stopping = t->stop.load(std::memory_order_acquire);
+
+		if (dz_settings *next = t->pending.exchange(nullptr, std::memory_order_acq_rel)) {
+			dz_timeline_adopt(&t->timeline, t->cfg, next, now_us());
+			delete t->cfg;
+			t->cfg = next;
+		}
+
+		dz_input_event ev;
+		while (t->input.events.pop(ev))
+			dz_tel_apply(t, ev);
+		t->header->dropped.store(t->input.dropped_events.load(std::memory_order_relaxed),
+					 std::memory_order_relaxed);
+
+		if (stopping)
+			break;
+		os_sleep_ms(1);
+	}
+}
+
+static void dz_telemetry_close(dz_telemetry *t)
+{
+	if (t->header)
+		UnmapViewOfFile(t->header);
+	if (t->mapping)
+		CloseHandle(t->mapping);
+	t->header = nullptr;
+	t->records = nullptr;
+	t->mapping = nullptr;
+}
+
+static bool dz_telemetry_open(dz_telemetry *t, const char *name)
+{
+	char path[MAX_PATH];
+	wchar_t wpath[MAX_PATH];
+	_snprintf_s(path, _TRUNCATE, "Local\\%s", name);
+	if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH))
+		return false;
+
+	const DWORD size = (DWORD)(sizeof(dz_tel_header) + DZ_TEL_CAPACITY * sizeof(dz_tel_record));
+	t->mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, wpath);
+	if (!t->mapping)
+		return false;
+
+	// Another source or OBS instance is already the writer
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		dz_telemetry_close(t);
+		return false;
+	}
+
+	void *view = MapViewOfFile(t->mapping, FILE_MAP_WRITE, 0, 0, size);
+	if (!view) {
+		dz_telemetry_close(t);
+		return false;
+	}
+
+	// A new mapping is zeroed: every seq and head start at 0
+	t->header = (dz_tel_header *)view;
+	t->records = (dz_tel_record *)((uint8_t *)view + sizeof(dz_tel_header));
+	t->header->version = DZ_TEL_VERSION;
+	t->header->record_size = sizeof(dz_tel_record);
+	t->header->capacity = DZ_TEL_CAPACITY;
+	t->header->start_us = now_us();
+	std::atomic_thread_fence(std::memory_order_release);
+	t->header->magic = DZ_TEL_MAGIC;
+
+	blog(LOG_INFO, "[dz-input-analyzer] telemetry: exporting to %s", path);
+	return true;
+}
+
+static void dz_telemetry_stop(dz_telemetry *t)
+{
+	if (!t->active)
+		return;
+
+	dz_hub_detach(&t->input);
+	t->stop.store(true, std::memory_order_release);
+	if (t->thread.joinable())
+		t->thread.join();
+
+	blog(LOG_INFO, "[dz-input-analyzer] telemetry stopped: %llu records, %u dropped",
+	     (unsigned long long)t->written, t->input.dropped_events.load(std::memory_order_relaxed));
+
+	dz_telemetry_close(t);
+	t->active = false;
+}
+
+static void dz_telemetry_start(dz_telemetry *t, const char *name)
+{
+	if (!dz_telemetry_open(t, name)) {
+		blog(LOG_WARNING, "[dz-input-analyzer] cannot create telemetry mapping '%s'", name);
+		return;
+	}
+
+	// Clean slate: rows are adopted from the pending snapshot on the first pass
+	delete t->cfg;
+	t->cfg = nullptr;
+	dz_timeline_reset(&t->timeline);
+	t->written = 0;
+	t->input.dropped_events.store(0, std::memory_order_relaxed);
+	t->input.wants_motion.store(false, std::memory_order_relaxed);
+	t->stop.store(false, std::memory_order_relaxed);
+
+	t->thread = std::thread(dz_tel_main, t);
+	if (!dz_hub_attach(&t->input))
+		blog(LOG_WARNING, "[dz-input-analyzer] telemetry could not attach to the input hub");
+	t->name = name;
+	t->active = true;
+}
+
+// UI thread: rows is the snapshot of the row bindings to export with, owned from here on
+static void dz_telemetry_configure(dz_telemetry *t, bool enabled, const char *name, dz_settings *rows)
+{
+	std::lock_guard<std::mutex> guard(t->lock);
+	if (t->active && (!enabled || t->name != name))
+		dz_telemetry_stop(t);
+
+	if (!enabled) {
+		delete rows;
+		return;
+	}
+
+	delete t->pending.exchange(rows, std::memory_order_acq_rel);
+	if (!t->active)
+		dz_telemetry_start(t, name);
+}
+
+static void dz_telemetry_free(dz_telemetry *t)
+{
+	dz_telemetry_configure(t, false, "", nullptr);
+	delete t->pending.exchange(nullptr);
+	delete t->cfg;
+	delete t;
+}
+
+// ------------------------------------------------------------
+// Session replay (render thread)
+//
+// The whole file is mapped read-only; only the pages a seek or the playback cursor
+// touch are ever paged in. Page headers are the block index: a seek is a binary search
+// over page base times, then over the record deltas inside one page.
+//
+// Snapshots share a mapping while the file is unchanged, so editing unrelated settings
+// keeps the replay where it is; the last reference closes it.
+struct dz_replay_file {
+	std::atomic<int> refs{1};
+	std::string path;
+	uint64_t size = 0;
+	uint64_t mtime = 0; // last write, FILETIME ticks
+
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+	const uint8_t *view = nullptr;
+	uint32_t page_count = 0; // data pages, after the file header page
+	int64_t start_us = 0;
+};
+
+static bool dz_file_stamp(const wchar_t *wpath, uint64_t *size, uint64_t *mtime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA a;
+	if (!GetFileAttributesExW(wpath, GetFileExInfoStandard, &a))
+		return false;
+	*size = ((uint64_t)a.nFileSizeHigh << 32) | a.nFileSizeLow;
+	*mtime = ((uint64_t)a.ftLastWriteTime.dwHighDateTime << 32) | a.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+static void dz_replay_close(dz_replay_file *f)
+{
+	if (!f)
+		return;
+	if (f->view)
+		UnmapViewOfFile(f->view);
+	if (f->mapping)
+		CloseHandle(f->mapping);
+	if (f->file != INVALID_HANDLE_VALUE)
+		CloseHandle(f->file);
+	delete f;
+}
+
+static dz_replay_file *dz_replay_open(const char *path)
+{
+	if (!path || !*path)
+		return nullptr;
+
+	wchar_t wpath[MAX_PATH];
+	if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH))
+		return nullptr;
+
+	auto *f = new dz_replay_file();
+	f->path = path;
+	dz_file_stamp(wpath, &f->size, &f->mtime);
+
+	// The recorder may still be writing this file
+	f->file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+			      FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size{};
+	if (f->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(f->file, &size) ||
+	    size.QuadPart < (LONGLONG)DZ_REC_PAGE_SIZE * 2) {
+		dz_replay_close(f);
+		return nullptr;
+	}
+
+	f->mapping = CreateFileMappingW(f->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	f->view = f->mapping ? (const uint8_t *)MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!f->view) {
+		dz_replay_close(f);
 		return nullptr;
 	}
 
-	return hwnd;
+	const auto *fh = (const dz_rec_file_header *)f->view;
+	if (fh->magic != DZ_REC_FILE_MAGIC || fh->version != DZ_REC_VERSION || fh->page_size != DZ_REC_PAGE_SIZE ||
+	    fh->record_size != sizeof(dz_rec_record)) {
+		blog(LOG_WARNING, "[dz-input-analyzer] '%s' is not a session file", path);
+		dz_replay_close(f);
+		return nullptr;
+	}
+
+	f->start_us = fh->start_us;
+	f->page_count = (uint32_t)(size.QuadPart / DZ_REC_PAGE_SIZE) - 1;
+
+	// A page still being written when the file was mapped shows up zeroed
+	while (f->page_count) {
+		const auto *h = (const dz_rec_page_header *)(f->view + (uint64_t)f->page_count * DZ_REC_PAGE_SIZE);
+		if (h->magic == DZ_REC_PAGE_MAGIC && h->count)
+			break;
+		f->page_count--;
+	}
+
+	blog(LOG_INFO, "[dz-input-analyzer] replay: %s, %u pages", path, f->page_count);
+	return f;
+}
+
+static void dz_replay_release(dz_replay_file *f)
+{
+	if (f && f->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		dz_replay_close(f);
+}
+
+// Another reference to last if it maps path and the file has not changed since;
+// otherwise a fresh mapping
+static dz_replay_file *dz_replay_acquire(const char *path, dz_replay_file *last)
+{
+	if (last && path && last->path == path) {
+		wchar_t wpath[MAX_PATH];
+		uint64_t size, mtime;
+		if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH) && dz_file_stamp(wpath, &size, &mtime) &&
+		    size == last->size && mtime == last->mtime) {
+			last->refs.fetch_add(1, std::memory_order_relaxed);
+			return last;
+		}
+	}
+	return dz_replay_open(path);
+}
+
+static inline const dz_rec_page_header *dz_replay_page(const dz_replay_file *f, uint32_t page)
+{
+	return (const dz_rec_page_header *)(f->view + (uint64_t)(page + 1) * DZ_REC_PAGE_SIZE);
+}
+
+static inline uint32_t dz_replay_page_count(const dz_rec_page_header *h)
+{
+	return h->magic == DZ_REC_PAGE_MAGIC ? std::min(h->count, DZ_REC_RECORDS_PER_PAGE) : 0;
+}
+
+static inline const dz_rec_record *dz_replay_records(const dz_rec_page_header *h)
+{
+	return (const dz_rec_record *)((const uint8_t *)h + sizeof(dz_rec_page_header));
+}
+
+// Positions the cursor on the first record at or after t
+static void dz_replay_seek(const dz_replay_file *f, dz_replay_cursor *c, int64_t t)
+{
+	// Last page whose base is <= t
+	uint32_t lo = 0;
+	uint32_t hi = f->page_count;
+	while (lo < hi) {
+		const uint32_t mid = lo + (hi - lo) / 2;
+		if (dz_replay_page(f, mid)->base_us <= t)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	c->page = lo ? lo - 1 : 0;
+
+	const dz_rec_page_header *h = dz_replay_page(f, c->page);
+	const dz_rec_record *recs = dz_replay_records(h);
+	const int64_t rel = t - h->base_us;
+	const dz_rec_record *end = recs + dz_replay_page_count(h);
+	const dz_rec_record *it = std::partition_point(recs, end, [&](const dz_rec_record &r) {
+		return (int64_t)r.delta_us < rel;
+	});
+	c->index = (uint32_t)(it - recs);
+}
+
+// Feeds every record up to t into the timeline. Going backwards or jumping further than
+// the retention window rebuilds the timeline from a fresh seek instead of scanning.
+static void dz_replay_advance(dz_source_data *d, const dz_replay_file *f, int64_t t)
+{
+	dz_replay_cursor *c = &d->replay;
+	if (!f->page_count)
+		return;
+
+	if (!c->valid || t < c->last_us || t - c->last_us > d->cfg->history_us) {
+		dz_timeline_reset(&d->timeline);
+		dz_replay_seek(f, c, t - d->cfg->history_us);
+		c->valid = true;
+	}
+	c->last_us = t;
+
+	while (c->page < f->page_count) {
+		const dz_rec_page_header *h = dz_replay_page(f, c->page);
+		const uint32_t count = dz_replay_page_count(h);
+		const dz_rec_record *recs = dz_replay_records(h);
+
+		for (; c->index < count; c->index++) {
+			const dz_rec_record &r = recs[c->index];
+			dz_input_event ev;
+			ev.time_us = h->base_us + r.delta_us;
+			if (ev.time_us > t)
+				return;
+			ev.type = r.type;
+			ev.vkey = r.vkey;
+			ev.value = r.value;
+			dz_timeline_apply(&d->timeline, d->cfg, ev, nullptr);
+		}
+
+		c->page++;
+		c->index = 0;
+	}
+}
+
+// Replay position: media time of the linked source if there is one, else wall time
+// since replay mode was entered; both relative to the start of the recording.
+static int64_t dz_replay_time(const dz_source_data *d, const dz_replay_file *f, int64_t t_frame_us)
+{
+	int64_t offset_us = t_frame_us - d->replay_clock_us;
+
+	if (d->cfg->replay_media) {
+		obs_source_t *media = obs_weak_source_get_source(d->cfg->replay_media);
+		if (media) {
+			offset_us = obs_source_media_get_time(media) * 1000;
+			obs_source_release(media);
+		}
+	}
+
+	return f->start_us + offset_us + d->cfg->replay_offset_us;
 }
 
-// ------------------------------------------------------------
-// Drawing helpers (solid effect)
-static void dz_draw_rect(gs_effect_t *solid, float x, float y, float w, float h, const vec4 &c)
+// UI thread: keeps a reference to the newest snapshot's file for the next one to share
+static void dz_replay_remember(dz_source_data *d, dz_replay_file *f)
 {
-	gs_eparam_t *p = gs_effect_get_param_by_name(solid, "color");
-	if (!p)
-		return;
+	if (f)
+		f->refs.fetch_add(1, std::memory_order_relaxed);
+	dz_replay_release(d->replay_last);
+	d->replay_last = f;
+}
 
-	gs_effect_set_vec4(p, &c);
+dz_source_settings::~dz_source_settings()
+{
+	dz_replay_release(replay_file);
+	obs_weak_source_release(replay_media);
+}
+
+// ------------------------------------------------------------
+// Drawing (solid effect, batched)
 
-	gs_matrix_push();
-	gs_matrix_translate3f(x, y, 0.0f);
+// Copies the queued vertices into the batch's dynamic vertex buffer
+static void dz_batch_upload(dz_batch *b)
+{
+	const size_t n = b->points.size();
+	b->vb_count = 0;
+	if (n == 0)
+		return;
 
-	while (gs_effect_loop(solid, "Solid")) {
-		gs_draw_sprite(nullptr, 0, (uint32_t)w, (uint32_t)h);
+	if (!b->vb || n > b->vb_capacity) {
+		if (b->vb)
+			gs_vertexbuffer_destroy(b->vb);
+
+		const size_t cap = std::max<size_t>({n, b->vb_capacity * 2, 4096});
+		gs_vb_data *vbd = gs_vbdata_create();
+		vbd->num = cap;
+		vbd->points = (vec3 *)bzalloc(sizeof(vec3) * cap);
+		vbd->colors = (uint32_t *)bzalloc(sizeof(uint32_t) * cap);
+		b->vb = gs_vertexbuffer_create(vbd, GS_DYNAMIC);
+		b->vb_capacity = b->vb ? cap : 0;
+		if (!b->vb)
+			return;
 	}
 
-	gs_matrix_pop();
+	gs_vb_data *vbd = gs_vertexbuffer_get_data(b->vb);
+	memcpy(vbd->points, b->points.data(), n * sizeof(vec3));
+	memcpy(vbd->colors, b->colors.data(), n * sizeof(uint32_t));
+	gs_vertexbuffer_flush(b->vb);
+	b->vb_count = n;
+	b->vb_lines_first = b->lines_first;
+	b->vb_lines_count = b->lines_count;
 }
 
-// Minimal bitmap font (5x7) for letters and numbers
-static uint8_t glyph_5x7(char ch, int row)
+// Draws the last upload in a single call, or three around its line run. Primitives
+// rasterize in submission order, so the batch keeps painter's order.
+static void dz_batch_submit(const dz_batch *b, gs_effect_t *solid, gs_eparam_t *color)
 {
-	// Each glyph: 7 rows of 5 bits (MSB left)
-	// Return bitmask for given row (0..6), bits in 0..4.
-	switch (ch) {
-	case 'A': {
-		static const uint8_t g[7] = {0b00100, 0b01010, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001};
-		return g[row];
-	}
-	case 'B': {
-		static const uint8_t g[7] = {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110};
-		return g[row];
-	}
-	case 'C': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110};
-		return g[row];
-	}
-	case 'D': {
-		static const uint8_t g[7] = {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110};
-		return g[row];
-	}
-	case 'E': {
-		static const uint8_t g[7] = {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111};
-		return g[row];
-	}
-	case 'F': {
-		static const uint8_t g[7] = {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000};
-		return g[row];
-	}
-	case 'G': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case 'H': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001};
-		return g[row];
-	}
-	case 'I': {
-		static const uint8_t g[7] = {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110};
-		return g[row];
-	}
-	case 'J': {
-		static const uint8_t g[7] = {0b00111, 0b00010, 0b00010, 0b00010, 0b10010, 0b10010, 0b01100};
-		return g[row];
-	}
-	case 'K': {
-		static const uint8_t g[7] = {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001};
-		return g[row];
-	}
-	case 'L': {
-		static const uint8_t g[7] = {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111};
-		return g[row];
-	}
-	case 'M': {
-		static const uint8_t g[7] = {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001};
-		return g[row];
-	}
-	case 'N': {
-		static const uint8_t g[7] = {0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001, 0b10001};
-		return g[row];
-	}
-	case 'O': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case 'P': {
-		static const uint8_t g[7] = {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000};
-		return g[row];
-	}
-	case 'Q': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101};
-		return g[row];
-	}
-	case 'R': {
-		static const uint8_t g[7] = {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001};
-		return g[row];
-	}
-	case 'S': {
-		static const uint8_t g[7] = {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110};
-		return g[row];
-	}
-	case 'T': {
-		static const uint8_t g[7] = {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100};
-		return g[row];
-	}
-	case 'U': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case 'V': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100};
-		return g[row];
-	}
-	case 'W': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010};
-		return g[row];
-	}
-	case 'X': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001};
-		return g[row];
-	}
-	case 'Y': {
-		static const uint8_t g[7] = {0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100};
-		return g[row];
-	}
-	case 'Z': {
-		static const uint8_t g[7] = {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111};
-		return g[row];
-	}
-	case '0': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case '1': {
-		static const uint8_t g[7] = {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110};
-		return g[row];
-	}
-	case '2': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111};
-		return g[row];
-	}
-	case '3': {
-		static const uint8_t g[7] = {0b11110, 0b00001, 0b00001, 0b01110, 0b00001, 0b00001, 0b11110};
-		return g[row];
-	}
-	case '4': {
-		static const uint8_t g[7] = {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010};
-		return g[row];
-	}
-	case '5': {
-		static const uint8_t g[7] = {0b11111, 0b10000, 0b10000, 0b11110, 0b00001, 0b00001, 0b11110};
-		return g[row];
-	}
-	
-	case '6': {
-		static const uint8_t g[7] = {0b01110, 0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case '7': {
-		static const uint8_t g[7] = {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000};
-		return g[row];
-	}
-	case '8': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110};
-		return g[row];
-	}
-	case '9': {
-		static const uint8_t g[7] = {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00001, 0b01110};
-		return g[row];
+	if (!b->vb_count)
+		return;
+
+	// SolidColored multiplies the vertex color by "color"
+	if (color) {
+		vec4 white;
+		vec4_set(&white, 1.0f, 1.0f, 1.0f, 1.0f);
+		gs_effect_set_vec4(color, &white);
 	}
-	default:
-		return 0;
+
+	gs_load_vertexbuffer(b->vb);
+	gs_load_indexbuffer(nullptr);
+	const uint32_t a = (uint32_t)b->vb_lines_first;
+	const uint32_t m = (uint32_t)b->vb_lines_count;
+	const uint32_t n = (uint32_t)b->vb_count;
+	while (gs_effect_loop(solid, "SolidColored")) {
+		if (!m) {
+			gs_draw(GS_TRIS, 0, n);
+			continue;
+		}
+		if (a)
+			gs_draw(GS_TRIS, 0, a);
+		gs_draw(GS_LINES, a, m);
+		if (a + m < n)
+			gs_draw(GS_TRIS, a + m, n - a - m);
 	}
+	gs_load_vertexbuffer(nullptr);
 }
 
-static void dz_draw_text_5x7(gs_effect_t *solid, float x, float y, const char *text, float scale, const vec4 &color)
+static uint32_t dz_batch_draws(const dz_batch *b)
 {
-	if (!text || !*text)
-		return;
-
-	const float px = std::max(1.0f, std::floor(scale));
-	const float cell = px;
+	if (!b->vb_lines_count)
+		return b->vb_count ? 1 : 0;
+	return 1 + (b->vb_lines_first ? 1 : 0) + (b->vb_lines_first + b->vb_lines_count < b->vb_count ? 1 : 0);
+}
 
-	float pen_x = x;
-	for (const char *p = text; *p; ++p) {
-		const char ch = *p;
-		if (ch == ' ') {
-			pen_x += 6.0f * cell;
-			continue;
-		}
+static void dz_batch_draw(dz_batch *b, gs_effect_t *solid, gs_eparam_t *color)
+{
+	dz_batch_upload(b);
+	dz_batch_submit(b, solid, color);
+}
 
-		for (int r = 0; r < 7; r++) {
-			const uint8_t bits = glyph_5x7(ch, r);
-			for (int c = 0; c < 5; c++) {
-				if (bits & (1u << (4 - c))) {
-					dz_draw_rect(solid, pen_x + c * cell, y + r * cell, cell, cell, color);
-				}
-			}
-		}
-		pen_x += 6.0f * cell; // 5 + 1 space
+static void dz_batch_free(dz_batch *b)
+{
+	if (b->vb) {
+		gs_vertexbuffer_destroy(b->vb);
+		b->vb = nullptr;
 	}
+	b->vb_capacity = 0;
+	b->vb_count = 0;
 }
 
 // ------------------------------------------------------------
@@ -639,14 +2016,11 @@ static bool dz_on_key_modified(obs_properties_t *props, obs_property_t *property
 	const uint16_t vkey = (uint16_t)obs_data_get_int(settings, prop_name);
 	const char *group_id = nullptr;
 
-	if (strcmp(prop_name, "row_w_key") == 0)
-		group_id = "row_w_group";
-	else if (strcmp(prop_name, "row_s_key") == 0)
-		group_id = "row_s_group";
-	else if (strcmp(prop_name, "row_a_key") == 0)
-		group_id = "row_a_group";
-	else if (strcmp(prop_name, "row_d_key") == 0)
-		group_id = "row_d_group";
+	char key[32], group_buf[32];
+	for (int i = 0; i < DZ_MAX_ROWS && !group_id; i++) {
+		if (strcmp(prop_name, dz_row_setting(key, "row_%s_key", i)) == 0)
+			group_id = dz_row_setting(group_buf, "row_%s_group", i);
+	}
 
 	if (!group_id)
 		return true;
@@ -659,49 +2033,210 @@ static bool dz_on_key_modified(obs_properties_t *props, obs_property_t *property
 	obs_property_set_description(group, title.c_str());
 	return true;
 }
-static const char *dz_source_get_name(void *unused)
+
+static bool dz_on_row_count_modified(obs_properties_t *props, obs_property_t *property, obs_data_t *settings)
 {
-	UNUSED_PARAMETER(unused);
-	return "DZ Input Analyzer";
+	UNUSED_PARAMETER(property);
+
+	const int rows = (int)obs_data_get_int(settings, "row_count");
+	char group_id[32];
+	for (int i = 0; i < DZ_MAX_ROWS; i++) {
+		obs_property_t *group = obs_properties_get(props, dz_row_setting(group_id, "row_%s_group", i));
+		if (group)
+			obs_property_set_visible(group, i < rows);
+	}
+	return true;
 }
+enum dz_input_mode : int { DZ_INPUT_LIVE = 0, DZ_INPUT_REPLAY = 1 };
 
-static void *dz_source_create(obs_data_t *settings, obs_source_t *source)
+static void dz_read_rows(obs_data_t *settings, dz_settings *s)
 {
-	UNUSED_PARAMETER(source);
+	s->row_count = std::clamp((int)obs_data_get_int(settings, "row_count"), 1, DZ_MAX_ROWS);
+	char name[32];
+	for (int i = 0; i < s->row_count; i++) {
+		s->key_color[i] = (uint32_t)obs_data_get_int(settings, dz_row_setting(name, "color_%s", i));
+		s->row_key_vkey[i] = dz_get_vkey(settings, dz_row_setting(name, "row_%s_key", i), kRowDefaults[i].vkey);
+		s->row_enabled[i] = obs_data_get_bool(settings, dz_row_setting(name, "row_%s_enabled", i));
+		s->row_debounce_ms[i] = (uint8_t)std::clamp<int64_t>(
+			obs_data_get_int(settings, dz_row_setting(name, "row_%s_debounce", i)), 0, DZ_MAX_DEBOUNCE_MS);
+		if (s->row_enabled[i])
+			s->visible_row[s->visible_count++] = (uint8_t)i;
+	}
+	dz_update_row_keys(s);
+}
 
-	auto *d = new dz_source_data();
+// last_replay: the replay file of the previous snapshot, shared if it is still the same
+static dz_source_settings *dz_read_settings(obs_data_t *settings, dz_replay_file *last_replay)
+{
+	auto *s = new dz_source_settings();
 
 	const int w = (int)obs_data_get_int(settings, "width");
 	const int h = (int)obs_data_get_int(settings, "height");
 	if (w > 0)
-		d->width = (uint32_t)w;
+		s->width = (uint32_t)w;
 	if (h > 0)
-		d->height = (uint32_t)h;
-
-	d->bg_alpha = (float)obs_data_get_double(settings, "bg_alpha");
-	d->bg_alpha = std::clamp(d->bg_alpha, 0.0f, 1.0f);
-
-	d->bg_color = (uint32_t)obs_data_get_int(settings, "bg_color");
-	d->key_color[ROW_W] = (uint32_t)obs_data_get_int(settings, "color_w");
-	d->key_color[ROW_S] = (uint32_t)obs_data_get_int(settings, "color_s");
-	d->key_color[ROW_A] = (uint32_t)obs_data_get_int(settings, "color_a");
-	d->key_color[ROW_D] = (uint32_t)obs_data_get_int(settings, "color_d");
-	d->row_key_vkey[ROW_W] = dz_get_vkey(settings, "row_w_key", 'W');
-	d->row_key_vkey[ROW_S] = dz_get_vkey(settings, "row_s_key", 'S');
-	d->row_key_vkey[ROW_A] = dz_get_vkey(settings, "row_a_key", 'A');
-	d->row_key_vkey[ROW_D] = dz_get_vkey(settings, "row_d_key", 'D');
-	d->row_enabled[ROW_W] = obs_data_get_bool(settings, "row_w_enabled");
-	d->row_enabled[ROW_S] = obs_data_get_bool(settings, "row_s_enabled");
-	d->row_enabled[ROW_A] = obs_data_get_bool(settings, "row_a_enabled");
-	d->row_enabled[ROW_D] = obs_data_get_bool(settings, "row_d_enabled");
+		s->height = (uint32_t)h;
+
+	s->bg_alpha = (float)obs_data_get_double(settings, "bg_alpha");
+	s->bg_alpha = std::clamp(s->bg_alpha, 0.0f, 1.0f);
+	s->show_sub_ms = obs_data_get_bool(settings, "delta_sub_ms");
+
+	const int64_t window_s = std::clamp<int64_t>(obs_data_get_int(settings, "window_s"), 1, 60);
+	const int64_t history_s = std::clamp<int64_t>(obs_data_get_int(settings, "history_s"), window_s, 600);
+	s->window_us = window_s * 1000000;
+	s->history_us = history_s * 1000000;
+	s->history_capacity = dz_history_capacity(s->history_us);
+
+	s->bg_color = (uint32_t)obs_data_get_int(settings, "bg_color");
+
+	if (obs_data_get_int(settings, "input_mode") == DZ_INPUT_REPLAY) {
+		s->replay_file = dz_replay_acquire(obs_data_get_string(settings, "replay_file"), last_replay);
+
+		const char *media_name = obs_data_get_string(settings, "replay_media");
+		obs_source_t *media = (media_name && *media_name) ? obs_get_source_by_name(media_name) : nullptr;
+		if (media) {
+			s->replay_media = obs_source_get_weak_source(media);
+			obs_source_release(media);
+		}
+		s->replay_offset_us = obs_data_get_int(settings, "replay_offset_ms") * 1000;
+	}
+
+	s->show_stats = obs_data_get_bool(settings, "strafe_stats");
+	s->perf_overlay = obs_data_get_bool(settings, "perf_overlay");
+	s->perf_log = obs_data_get_bool(settings, "perf_log");
+	s->gpu_timeline = obs_data_get_bool(settings, "gpu_timeline");
+	s->async_build = obs_data_get_bool(settings, "async_build");
+	s->show_motion = obs_data_get_bool(settings, "motion_lane");
+	s->motion_full_scale = (uint32_t)std::clamp<int64_t>(obs_data_get_int(settings, "motion_full_scale"), 1, 1000);
+
+	dz_read_rows(settings, s);
+	return s;
+}
+
+// Row bindings for the telemetry export; its timeline only needs the latest few items
+static void dz_configure_telemetry(dz_telemetry *t, obs_data_t *settings)
+{
+	const bool enabled = obs_data_get_bool(settings, "telemetry");
+	dz_settings *rows = nullptr;
+	if (enabled) {
+		rows = new dz_settings();
+		dz_read_rows(settings, rows);
+		rows->history_capacity = DZ_IDLE_ROW_CAPACITY;
+	}
+	dz_telemetry_configure(t, enabled, obs_data_get_string(settings, "telemetry_name"), rows);
+}
+
+static void dz_store_output_size(dz_source_data *d, const dz_settings *s)
+{
+	d->out_cx.store(s->width, std::memory_order_relaxed);
+	d->out_cy.store((uint32_t)std::round(std::max(0.0f, dz_visible_height(s))), std::memory_order_relaxed);
+}
+
+// UI thread: hands a new snapshot to the render thread
+static void dz_publish_settings(dz_source_data *d, dz_source_settings *next)
+{
+	dz_store_output_size(d, next);
+	dz_subscriber_set_debounce(&d->input, next);
+
+	// A snapshot still pending was never seen by the render thread
+	dz_source_settings *stale = d->pending.exchange(next, std::memory_order_acq_rel);
+	delete stale;
+}
+
+static void dz_on_record_hotkey(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey, bool pressed)
+{
+	UNUSED_PARAMETER(id);
+	UNUSED_PARAMETER(hotkey);
+
+	auto *d = (dz_source_data *)data;
+	if (pressed)
+		dz_recorder_toggle(d->recorder);
+}
+
+#if defined(DZ_FRONTEND_API)
+static void dz_on_frontend_event(enum obs_frontend_event event, void *data)
+{
+	auto *d = (dz_source_data *)data;
+	if (event != OBS_FRONTEND_EVENT_RECORDING_STARTED && event != OBS_FRONTEND_EVENT_RECORDING_STOPPED)
+		return;
+
+	bool with_obs;
+	{
+		std::lock_guard<std::mutex> guard(d->recorder->lock);
+		with_obs = d->recorder->with_obs;
+	}
+	if (!with_obs)
+		return;
+
+	if (event == OBS_FRONTEND_EVENT_RECORDING_STARTED)
+		dz_recorder_start(d->recorder);
+	else
+		dz_recorder_stop(d->recorder);
+}
+#endif
+
+static const char *dz_source_get_name(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "DZ Input Analyzer";
+}
+
+static void *dz_source_create(obs_data_t *settings, obs_source_t *source)
+{
+	auto *d = new dz_source_data();
+	d->source = source;
+	dz_timeline_init(&d->timeline);
+
+	// No render callback can run yet, so the first snapshot is adopted directly
+	dz_source_settings *cfg = dz_read_settings(settings, nullptr);
+	dz_replay_remember(d, cfg->replay_file);
+	dz_store_output_size(d, cfg);
+	dz_subscriber_set_debounce(&d->input, cfg);
+	dz_adopt_settings(d, cfg, now_us());
 
 	obs_enter_graphics();
 	d->solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+	if (d->solid)
+		d->solid_color = gs_effect_get_param_by_name(d->solid, "color");
+	d->image_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	if (d->image_effect)
+		d->image_param = gs_effect_get_param_by_name(d->image_effect, "image");
+
+	char *effect_path = obs_module_file("dz-timeline.effect");
+	if (effect_path) {
+		char *errors = nullptr;
+		d->timeline_effect = gs_effect_create_from_file(effect_path, &errors);
+		if (!d->timeline_effect)
+			blog(LOG_WARNING, "[dz-input-analyzer] %s failed to load, drawing on the CPU: %s", effect_path,
+			     errors ? errors : "(no details)");
+		bfree(errors);
+		bfree(effect_path);
+	}
+	if (d->timeline_effect) {
+		d->timeline_image = gs_effect_get_param_by_name(d->timeline_effect, "image");
+		d->timeline_size = gs_effect_get_param_by_name(d->timeline_effect, "size");
+		d->timeline_window = gs_effect_get_param_by_name(d->timeline_effect, "window");
+		d->timeline_extent = gs_effect_get_param_by_name(d->timeline_effect, "extent");
+	}
 	obs_leave_graphics();
 
-	d->hwnd = dz_create_hidden_window(d);
+	d->subscribed = dz_hub_attach(&d->input);
+
+	d->recorder = new dz_recorder();
+	dz_recorder_configure(d->recorder, obs_data_get_string(settings, "record_dir"),
+			      obs_data_get_bool(settings, "record_with_obs"));
+	d->record_hotkey = obs_hotkey_register_source(source, "dz_input_analyzer.record",
+						      "Start/Stop Input Session Recording", dz_on_record_hotkey, d);
+#if defined(DZ_FRONTEND_API)
+	obs_frontend_add_event_callback(dz_on_frontend_event, d);
+#endif
 
-	blog(LOG_INFO, "[dz-input-analyzer] create: %ux%u solid=%p hwnd=%p", d->width, d->height, d->solid, d->hwnd);
+	d->telemetry = new dz_telemetry();
+	dz_timeline_init(&d->telemetry->timeline);
+	dz_configure_telemetry(d->telemetry, settings);
+
+	blog(LOG_INFO, "[dz-input-analyzer] create: %ux%u solid=%p input=%s", cfg->width, cfg->height, d->solid,
+	     d->subscribed ? "yes" : "no");
 	return d;
 }
 
@@ -713,32 +2248,59 @@ static void dz_source_destroy(void *data)
 
 	blog(LOG_INFO, "[dz-input-analyzer] destroy");
 
-	if (d->hwnd) {
-		DestroyWindow(d->hwnd);
-		d->hwnd = nullptr;
+#if defined(DZ_FRONTEND_API)
+	obs_frontend_remove_event_callback(dz_on_frontend_event, d);
+#endif
+	if (d->record_hotkey != OBS_INVALID_HOTKEY_ID)
+		obs_hotkey_unregister(d->record_hotkey);
+	dz_recorder_stop(d->recorder);
+	delete d->recorder;
+	dz_telemetry_free(d->telemetry);
+
+	if (d->subscribed) {
+		dz_hub_detach(&d->input);
+		d->subscribed = false;
 	}
+	if (d->cfg && dz_perf_enabled(d->cfg))
+		dz_perf_enable(d, false, 0);
+	dz_builder_enable(d, false);
 
 	obs_enter_graphics();
+	dz_batch_free(&d->batch);
+	if (d->static_layer) {
+		gs_texrender_destroy(d->static_layer);
+		d->static_layer = nullptr;
+	}
 	d->solid = nullptr;
+	d->solid_color = nullptr;
+	d->image_effect = nullptr;
+	d->image_param = nullptr;
+	if (d->timeline_events) {
+		gs_texture_destroy(d->timeline_events);
+		d->timeline_events = nullptr;
+	}
+	if (d->timeline_effect) {
+		gs_effect_destroy(d->timeline_effect);
+		d->timeline_effect = nullptr;
+	}
 	obs_leave_graphics();
 
+	delete d->pending.exchange(nullptr);
+	delete d->cfg;
+	dz_replay_release(d->replay_last);
 	delete d;
 }
 
 static uint32_t dz_source_get_width(void *data)
 {
 	auto *d = (dz_source_data *)data;
-	return d ? d->width : 0;
+	return d ? d->out_cx.load(std::memory_order_relaxed) : 0;
 }
 
 static uint32_t dz_source_get_height(void *data)
 {
 	auto *d = (dz_source_data *)data;
-	if (!d)
-		return 0;
-
-	const float visible_h = dz_visible_height(d);
-	return (uint32_t)std::round(std::max(0.0f, visible_h));
+	return d ? d->out_cy.load(std::memory_order_relaxed) : 0;
 }
 
 static void dz_source_defaults(obs_data_t *settings)
@@ -748,23 +2310,40 @@ static void dz_source_defaults(obs_data_t *settings)
 	obs_data_set_default_int(settings, "height", 520);
 
 	obs_data_set_default_double(settings, "bg_alpha", 0.55);
+	obs_data_set_default_bool(settings, "delta_sub_ms", false);
+	obs_data_set_default_int(settings, "window_s", 5);
+	obs_data_set_default_int(settings, "history_s", 30);
 
 	// Colors are COLORREF (BGR): 0x00BBGGRR
 	obs_data_set_default_int(settings, "bg_color", 0x000000);
-	obs_data_set_default_int(settings, "color_w", 0x005dc8f3); // #f3c85d
-	obs_data_set_default_int(settings, "color_s", 0x009cff9c); // #9cff9c
-	obs_data_set_default_int(settings, "color_a", 0x003f3fcf); // #cf3f3f
-	obs_data_set_default_int(settings, "color_d", 0x00c8a00a); // #0aa0c8
-
-	obs_data_set_default_int(settings, "row_w_key", 'W');
-	obs_data_set_default_int(settings, "row_s_key", 'S');
-	obs_data_set_default_int(settings, "row_a_key", 'A');
-	obs_data_set_default_int(settings, "row_d_key", 'D');
 
-	obs_data_set_default_bool(settings, "row_w_enabled", true);
-	obs_data_set_default_bool(settings, "row_s_enabled", true);
-	obs_data_set_default_bool(settings, "row_a_enabled", true);
-	obs_data_set_default_bool(settings, "row_d_enabled", true);
+	obs_data_set_default_int(settings, "input_mode", DZ_INPUT_LIVE);
+	obs_data_set_default_string(settings, "replay_file", "");
+	obs_data_set_default_string(settings, "replay_media", "");
+	obs_data_set_default_int(settings, "replay_offset_ms", 0);
+
+	obs_data_set_default_string(settings, "record_dir", "");
+	obs_data_set_default_bool(settings, "record_with_obs", false);
+
+	obs_data_set_default_bool(settings, "telemetry", false);
+	obs_data_set_default_string(settings, "telemetry_name", "dz-input-analyzer");
+
+	obs_data_set_default_bool(settings, "strafe_stats", false);
+	obs_data_set_default_bool(settings, "perf_overlay", false);
+	obs_data_set_default_bool(settings, "perf_log", false);
+	obs_data_set_default_bool(settings, "gpu_timeline", true);
+	obs_data_set_default_bool(settings, "async_build", true);
+	obs_data_set_default_bool(settings, "motion_lane", false);
+	obs_data_set_default_int(settings, "motion_full_scale", 40);
+
+	obs_data_set_default_int(settings, "row_count", DZ_DEFAULT_ROWS);
+	char name[32];
+	for (int i = 0; i < DZ_MAX_ROWS; i++) {
+		obs_data_set_default_int(settings, dz_row_setting(name, "color_%s", i), kRowDefaults[i].color);
+		obs_data_set_default_int(settings, dz_row_setting(name, "row_%s_key", i), kRowDefaults[i].vkey);
+		obs_data_set_default_bool(settings, dz_row_setting(name, "row_%s_enabled", i), true);
+		obs_data_set_default_int(settings, dz_row_setting(name, "row_%s_debounce", i), 0);
+	}
 }
 
 static obs_properties_t *dz_source_properties(void *data)
@@ -776,55 +2355,105 @@ static obs_properties_t *dz_source_properties(void *data)
 	obs_properties_add_float_slider(p, "bg_alpha", "Background Opacity", 0.0, 1.0, 0.01);
 
 	obs_properties_add_color(p, "bg_color", "Background Color");
+	obs_properties_add_bool(p, "delta_sub_ms", "Show Sub-Millisecond Deltas");
 
-	const uint16_t vkey_w = d ? d->row_key_vkey[ROW_W] : (uint16_t)'W';
-	const uint16_t vkey_s = d ? d->row_key_vkey[ROW_S] : (uint16_t)'S';
-	const uint16_t vkey_a = d ? d->row_key_vkey[ROW_A] : (uint16_t)'A';
-	const uint16_t vkey_d = d ? d->row_key_vkey[ROW_D] : (uint16_t)'D';
+	obs_property_t *window = obs_properties_add_int_slider(p, "window_s", "Display Window", 1, 60, 1);
+	obs_property_int_set_suffix(window, " s");
+	obs_property_t *history = obs_properties_add_int(p, "history_s", "History Retention", 5, 600, 1);
+	obs_property_int_set_suffix(history, " s");
 
 	{
 		obs_properties_t *group = obs_properties_create();
-		obs_property_t *list = obs_properties_add_list(group, "row_w_key", "Monitored Key",
-								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
-		dz_fill_key_list(list);
-		obs_property_set_modified_callback(list, dz_on_key_modified);
-		obs_properties_add_color(group, "color_w", "Row Color");
-		obs_properties_add_bool(group, "row_w_enabled", "Show Row");
-		obs_properties_add_group(p, "row_w_group", dz_key_title(vkey_w).c_str(), OBS_GROUP_NORMAL, group);
+		obs_property_t *mode = obs_properties_add_list(group, "input_mode", "Input", OBS_COMBO_TYPE_LIST,
+							       OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(mode, "Live Input", DZ_INPUT_LIVE);
+		obs_property_list_add_int(mode, "Replay Session File", DZ_INPUT_REPLAY);
+		obs_properties_add_path(group, "replay_file", "Session File", OBS_PATH_FILE, "DZ Sessions (*.dzrec)",
+					nullptr);
+		obs_property_t *media = obs_properties_add_text(group, "replay_media", "Sync To Media Source",
+								OBS_TEXT_DEFAULT);
+		obs_property_set_long_description(media, "Name of the media source playing the VOD; "
+							 "empty plays the session in real time");
+		obs_property_t *offset = obs_properties_add_int(group, "replay_offset_ms", "Sync Offset", -600000,
+								600000, 1);
+		obs_property_int_set_suffix(offset, " ms");
+		obs_properties_add_group(p, "replay_group", "Session Replay", OBS_GROUP_NORMAL, group);
 	}
 
 	{
 		obs_properties_t *group = obs_properties_create();
-		obs_property_t *list = obs_properties_add_list(group, "row_s_key", "Monitored Key",
-								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
-		dz_fill_key_list(list);
-		obs_property_set_modified_callback(list, dz_on_key_modified);
-		obs_properties_add_color(group, "color_s", "Row Color");
-		obs_properties_add_bool(group, "row_s_enabled", "Show Row");
-		obs_properties_add_group(p, "row_s_group", dz_key_title(vkey_s).c_str(), OBS_GROUP_NORMAL, group);
+		obs_property_t *dir = obs_properties_add_path(group, "record_dir", "Session Folder", OBS_PATH_DIRECTORY,
+							      nullptr, nullptr);
+		obs_property_set_long_description(dir, "Leave empty to use the plugin's config folder");
+#if defined(DZ_FRONTEND_API)
+		obs_properties_add_bool(group, "record_with_obs", "Record Together With OBS Recording");
+#endif
+		obs_properties_add_group(p, "record_group", "Session Recording", OBS_GROUP_NORMAL, group);
 	}
 
 	{
 		obs_properties_t *group = obs_properties_create();
-		obs_property_t *list = obs_properties_add_list(group, "row_a_key", "Monitored Key",
-								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
-		dz_fill_key_list(list);
-		obs_property_set_modified_callback(list, dz_on_key_modified);
-		obs_properties_add_color(group, "color_a", "Row Color");
-		obs_properties_add_bool(group, "row_a_enabled", "Show Row");
-		obs_properties_add_group(p, "row_a_group", dz_key_title(vkey_a).c_str(), OBS_GROUP_NORMAL, group);
+		obs_properties_add_bool(group, "telemetry", "Export Live Telemetry");
+		obs_property_t *name =
+			obs_properties_add_text(group, "telemetry_name", "Shared Memory Name", OBS_TEXT_DEFAULT);
+		obs_property_set_long_description(name, "Dashboards open Local\\<name>; one source per name");
+		obs_properties_add_group(p, "telemetry_group", "Live Telemetry", OBS_GROUP_NORMAL, group);
 	}
 
+	obs_properties_add_bool(p, "strafe_stats", "Show Counter-Strafe Stats");
+	obs_properties_add_bool(p, "motion_lane", "Show Mouse Velocity Lane");
+	obs_property_t *scale = obs_properties_add_int(p, "motion_full_scale", "Mouse Lane Full Scale", 1, 1000, 1);
+	obs_property_int_set_suffix(scale, " counts/ms");
+
 	{
 		obs_properties_t *group = obs_properties_create();
-		obs_property_t *list = obs_properties_add_list(group, "row_d_key", "Monitored Key",
-								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+		obs_properties_add_bool(group, "perf_overlay", "Show Performance Overlay");
+		obs_property_t *log = obs_properties_add_bool(group, "perf_log", "Log Performance Summary");
+		obs_property_set_long_description(log, "Writes p50/p99 timings to the OBS log every 10 seconds");
+		obs_property_t *gpu = obs_properties_add_bool(group, "gpu_timeline", "Draw Key Timeline in a Shader");
+		obs_property_set_long_description(gpu,
+						  "Turn off to build key segments and clicks as geometry on the CPU. "
+						  "Used anyway while a row has over 16 clicks within a label's width.");
+		obs_property_t *async = obs_properties_add_bool(group, "async_build", "Build Frames on a Worker Thread");
+		obs_property_set_long_description(async, "Keeps geometry work off the OBS graphics thread");
+		obs_properties_add_group(p, "perf_group", "Diagnostics", OBS_GROUP_NORMAL, group);
+	}
+
+	obs_property_t *rows = obs_properties_add_int_slider(p, "row_count", "Rows", 1, DZ_MAX_ROWS, 1);
+	obs_property_set_modified_callback(rows, dz_on_row_count_modified);
+
+	// Read the bindings from the source settings; the snapshots belong to the render thread
+	obs_data_t *settings = (d && d->source) ? obs_source_get_settings(d->source) : nullptr;
+	const int row_count = settings ? (int)obs_data_get_int(settings, "row_count") : DZ_DEFAULT_ROWS;
+
+	for (int i = 0; i < DZ_MAX_ROWS; i++) {
+		char key[32], color[32], enabled[32], debounce[32], group_id[32];
+		dz_row_setting(key, "row_%s_key", i);
+		dz_row_setting(color, "color_%s", i);
+		dz_row_setting(enabled, "row_%s_enabled", i);
+		dz_row_setting(debounce, "row_%s_debounce", i);
+		dz_row_setting(group_id, "row_%s_group", i);
+
+		const uint16_t fallback = kRowDefaults[i].vkey;
+		const uint16_t vkey = settings ? dz_get_vkey(settings, key, fallback) : fallback;
+
+		obs_properties_t *group = obs_properties_create();
+		obs_property_t *list =
+			obs_properties_add_list(group, key, "Monitored Key", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 		dz_fill_key_list(list);
 		obs_property_set_modified_callback(list, dz_on_key_modified);
-		obs_properties_add_color(group, "color_d", "Row Color");
-		obs_properties_add_bool(group, "row_d_enabled", "Show Row");
-		obs_properties_add_group(p, "row_d_group", dz_key_title(vkey_d).c_str(), OBS_GROUP_NORMAL, group);
+		obs_properties_add_color(group, color, "Row Color");
+		obs_properties_add_bool(group, enabled, "Show Row");
+		obs_property_t *db =
+			obs_properties_add_int_slider(group, debounce, "Debounce", 0, DZ_MAX_DEBOUNCE_MS, 1);
+		obs_property_set_long_description(db, "Key chatter shorter than this is dropped at capture");
+		obs_property_int_set_suffix(db, " ms");
+		obs_property_t *g =
+			obs_properties_add_group(p, group_id, dz_key_title(vkey).c_str(), OBS_GROUP_NORMAL, group);
+		obs_property_set_visible(g, i < row_count);
 	}
+
+	obs_data_release(settings);
 	return p;
 }
 
@@ -834,317 +2463,437 @@ static void dz_source_update(void *data, obs_data_t *settings)
 	if (!d)
 		return;
 
-	const int w = (int)obs_data_get_int(settings, "width");
-	const int h = (int)obs_data_get_int(settings, "height");
-	if (w > 0)
-		d->width = (uint32_t)w;
-	if (h > 0)
-		d->height = (uint32_t)h;
+	dz_source_settings *next = dz_read_settings(settings, d->replay_last);
+	dz_replay_remember(d, next->replay_file);
+	dz_recorder_configure(d->recorder, obs_data_get_string(settings, "record_dir"),
+			      obs_data_get_bool(settings, "record_with_obs"));
+	dz_configure_telemetry(d->telemetry, settings);
 
-	d->bg_alpha = (float)obs_data_get_double(settings, "bg_alpha");
-	d->bg_alpha = std::clamp(d->bg_alpha, 0.0f, 1.0f);
+	blog(LOG_INFO, "[dz-input-analyzer] update: %ux%u opacity=%.2f bg_color=%06x rows=%d (%d shown)",
+		next->width, next->height, next->bg_alpha,
+		(unsigned)(next->bg_color & 0xFFFFFF),
+		next->row_count, next->visible_count);
 
-	d->bg_color = (uint32_t)obs_data_get_int(settings, "bg_color");
-	d->key_color[ROW_W] = (uint32_t)obs_data_get_int(settings, "color_w");
-	d->key_color[ROW_S] = (uint32_t)obs_data_get_int(settings, "color_s");
-	d->key_color[ROW_A] = (uint32_t)obs_data_get_int(settings, "color_a");
-	d->key_color[ROW_D] = (uint32_t)obs_data_get_int(settings, "color_d");
+	dz_publish_settings(d, next);
+}
 
-	d->row_key_vkey[ROW_W] = dz_get_vkey(settings, "row_w_key", 'W');
-	d->row_key_vkey[ROW_S] = dz_get_vkey(settings, "row_s_key", 'S');
-	d->row_key_vkey[ROW_A] = dz_get_vkey(settings, "row_a_key", 'A');
-	d->row_key_vkey[ROW_D] = dz_get_vkey(settings, "row_d_key", 'D');
+// Debug overlay in the top left corner of the timeline, refreshed once per second
+static void dz_build_perf_overlay(const dz_source_data *d, const dz_layout &L, dz_batch *batch)
+{
+	if (!d->cfg->perf_overlay)
+		return;
 
-	d->row_enabled[ROW_W] = obs_data_get_bool(settings, "row_w_enabled");
-	d->row_enabled[ROW_S] = obs_data_get_bool(settings, "row_s_enabled");
-	d->row_enabled[ROW_A] = obs_data_get_bool(settings, "row_a_enabled");
-	d->row_enabled[ROW_D] = obs_data_get_bool(settings, "row_d_enabled");
+	const dz_perf &p = d->perf;
+	size_t len = 0;
+	for (const char *line : p.label)
+		len = std::max(len, strlen(line));
+	if (!len)
+		return;
 
-	for (int i = 0; i < ROW_COUNT; i++)
-		d->st.key_down[i].store(0, std::memory_order_relaxed);
+	const float x = L.timelineX0 + 4.0f;
+	const float y = L.topPad + 4.0f;
+	dz_batch_rect(batch, x, y, (float)len * 12.0f + 8.0f, 3 * 18.0f + 4.0f, dz_col_rgba(0.0f, 0.0f, 0.0f, 0.7f));
 
-	blog(LOG_INFO, "[dz-input-analyzer] update: %ux%u opacity=%.2f bg_color=%06x W=%06x S=%06x A=%06x D=%06x",
-		d->width, d->height, d->bg_alpha,
-		(unsigned)(d->bg_color & 0xFFFFFF),
-		(unsigned)(d->key_color[ROW_W] & 0xFFFFFF),
-		(unsigned)(d->key_color[ROW_S] & 0xFFFFFF),
-		(unsigned)(d->key_color[ROW_A] & 0xFFFFFF),
-		(unsigned)(d->key_color[ROW_D] & 0xFFFFFF));
+	const vec4 col = dz_col_rgba(1.0f, 1.0f, 0.4f, 1.0f);
+	for (int i = 0; i < 3; i++)
+		dz_draw_text_5x7(batch, x + 4.0f, y + 4.0f + i * 18.0f, p.label[i], 2.0f, col);
 }
 
-// Colors from movv.html
-static vec4 dz_col_rgba(float r, float g, float b, float a)
+// Renders the static layer into its cached texture; only after a settings change.
+static void dz_update_static_layer(dz_source_data *d, const dz_layout &L)
 {
-	vec4 c;
-	vec4_set(&c, r, g, b, a);
-	return c;
+	const uint32_t cx = d->cfg->width;
+	const uint32_t cy = (uint32_t)std::ceil(std::max(1.0f, L.H));
+
+	if (!d->static_dirty && d->static_cx == cx && d->static_cy == cy)
+		return;
+	d->static_dirty = false;
+
+	if (!d->static_layer)
+		d->static_layer = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	if (!d->static_layer)
+		return;
+
+	// Goes through the moving layer's vertex buffer, which then has to be rebuilt
+	dz_batch *batch = &d->batch;
+	dz_batch_clear(batch);
+	dz_build_static_layer(d->cfg, L, batch);
+	d->moving_dirty = true;
+
+	gs_texrender_reset(d->static_layer);
+	if (gs_texrender_begin(d->static_layer, cx, cy)) {
+		vec4 zero;
+		vec4_set(&zero, 0.0f, 0.0f, 0.0f, 0.0f);
+		gs_clear(GS_CLEAR_COLOR, &zero, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		// Same blending as the direct path, so compositing the texture gives identical output
+		gs_blend_state_push();
+		gs_reset_blend_state();
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		dz_batch_draw(batch, d->solid, d->solid_color);
+		gs_blend_state_pop();
+
+		gs_texrender_end(d->static_layer);
+		d->static_cx = cx;
+		d->static_cy = cy;
+	} else {
+		d->static_dirty = true;
+	}
 }
 
-// OBS color property uses Windows COLORREF (BGR): 0x00BBGGRR
-static inline vec4 dz_col_from_obs_bgr(uint32_t bgr, float a)
+static void dz_draw_static_layer(dz_source_data *d)
 {
-	const float r = (float)((bgr) & 0xFF) / 255.0f;
-	const float g = (float)((bgr >> 8) & 0xFF) / 255.0f;
-	const float b = (float)((bgr >> 16) & 0xFF) / 255.0f;
-	return dz_col_rgba(r, g, b, a);
+	gs_texture_t *tex = d->static_layer ? gs_texrender_get_texture(d->static_layer) : nullptr;
+	if (!tex || !d->image_effect)
+		return;
+
+	gs_effect_set_texture(d->image_param, tex);
+	while (gs_effect_loop(d->image_effect, "Draw")) {
+		gs_draw_sprite(tex, 0, d->static_cx, d->static_cy);
+	}
 }
 
-static vec4 row_color(const dz_source_data *d, int row, float a)
+// Events are stored relative to a base time so float precision holds; a long wait without
+// events moves the base along
+static constexpr int64_t DZ_EVENTS_REBASE_US = 10000000;
+
+// Fills in what the moving layer for tNow needs and whether anything has to be rebuilt.
+// Compares against what is uploaded, so it runs on the render thread.
+static void dz_moving_prepare(dz_source_data *d, dz_moving_frame *f, int64_t tNow)
 {
-	if (!d)
-		return dz_col_rgba(1.0f, 1.0f, 1.0f, a);
+	if (d->timeline_effect && !d->timeline_events) {
+		d->timeline_events =
+			gs_texture_create(DZ_GPU_TEX_WIDTH, DZ_GPU_TEX_HEIGHT, GS_RGBA32F, 1, nullptr, GS_DYNAMIC);
+		d->events_dirty = true;
+	}
 
-	const int idx = std::clamp(row, 0, ROW_COUNT - 1);
-	return dz_col_from_obs_bgr(d->key_color[idx], a);
+	f->cfg = d->cfg;
+	f->t_now = tNow;
+	f->revision = d->timeline.revision;
+	f->idle = dz_timeline_idle(&d->timeline, d->cfg, tNow);
+	f->gpu = d->cfg->gpu_timeline && d->timeline_events;
+
+	// Nothing changed since the last upload when no event arrived and either the clock
+	// stood still (paused replay) or everything has scrolled out
+	const bool current = !d->moving_dirty && f->gpu == d->drawn_gpu && f->revision == d->drawn_revision &&
+			     (tNow == d->drawn_us || (f->idle && d->drawn_idle));
+	f->built = !current;
+
+	f->events_filled = f->gpu && !f->idle &&
+			   (d->events_dirty || f->revision != d->events_revision ||
+			    tNow - d->events_base_us > DZ_EVENTS_REBASE_US || tNow >= d->events_later_us);
+	f->events_base_us = tNow;
+	if (f->events_filled && f->events.empty())
+		f->events.resize((size_t)DZ_GPU_TEX_WIDTH * DZ_GPU_TEX_HEIGHT * 4);
 }
 
-static float dz_base_row_height(const dz_source_data *d)
+// Builds what dz_moving_prepare asked for. Runs on the builder thread while one is
+// running, so it only reads what the render thread leaves alone until dz_builder_wait.
+static void dz_moving_build(dz_source_data *d, dz_moving_frame *f)
 {
-	if (!d)
-		return 0.0f;
+	const dz_layout &L = d->layout;
+	f->events_crowded = d->events_crowded;
+	if (f->events_filled)
+		f->events_crowded = !dz_build_gpu_timeline(f->cfg, &d->timeline, L, f->t_now, f->events_base_us,
+							   f->events.data(), (size_t)DZ_GPU_TEX_WIDTH * 4,
+							   &f->events_later_us);
+
+	// Clicks the shader would drop: the whole timeline goes back to the CPU until the
+	// texture is refilled without them (next event or rebase)
+	if (f->gpu && f->events_crowded) {
+		f->gpu = false;
+		f->built |= d->drawn_gpu;
+	}
 
-	const float H = (float)d->height;
-	const float topPad = 18.0f;
-	const float bottomPad = 55.0f;
-	const float rowGap = 20.0f;
-	const float rowsAreaH = H - topPad - bottomPad;
-	const float rowH = (rowsAreaH - rowGap * (ROW_COUNT - 1)) / (float)ROW_COUNT;
-	return std::max(0.0f, std::floor(rowH));
+	if (f->built) {
+		dz_batch *batch = &f->batch;
+		dz_batch_clear(batch);
+		if (!f->gpu)
+			dz_build_timeline(f->cfg, &d->timeline, L, f->t_now, batch);
+		dz_build_motion_lane(f->cfg, &d->timeline, L, f->t_now, batch);
+		dz_build_stats_strip(f->cfg, &d->timeline, L, batch);
+		dz_build_perf_overlay(d, L, batch);
+	}
 }
 
-static float dz_visible_height(const dz_source_data *d)
+// Copies the used part of each texel row into the event texture
+static bool dz_upload_gpu_events(dz_source_data *d, const dz_moving_frame *f)
 {
-	if (!d)
-		return 0.0f;
-
-	const float topPad = 18.0f;
-	const float bottomPad = 55.0f;
-	const float rowGap = 20.0f;
-	int visible_rows = 0;
-	for (int i = 0; i < ROW_COUNT; i++) {
-		if (d->row_enabled[i])
-			visible_rows++;
+	uint8_t *ptr;
+	uint32_t linesize;
+	if (!gs_texture_map(d->timeline_events, &ptr, &linesize))
+		return false;
+
+	const size_t stride = (size_t)DZ_GPU_TEX_WIDTH * 4;
+	const float *src = f->events.data();
+	auto copy_row = [&](int y, size_t texels) {
+		memcpy(ptr + (size_t)y * linesize, src + y * stride, std::min<size_t>(texels, DZ_GPU_TEX_WIDTH) * 16);
+	};
+	for (int v = 0; v < d->layout.visible_rows; v++) {
+		const float *hdr = src + v * stride;
+		copy_row(v, DZ_GPU_HEADER_TEXELS + (size_t)hdr[2]);
+		copy_row(DZ_MAX_ROWS + v, (size_t)hdr[3]);
 	}
+	copy_row(DZ_GPU_FONT_ROW, DZ_GPU_FONT_GLYPHS);
+	gs_texture_unmap(d->timeline_events);
+
+	d->events_base_us = f->events_base_us;
+	d->events_revision = f->revision;
+	d->events_dirty = false;
+	d->events_crowded = f->events_crowded;
+	d->events_later_us = f->events_later_us;
+	return true;
+}
 
-	if (visible_rows <= 0)
-		return topPad + bottomPad;
+// Makes f what the moving layer shows: swaps its vertices in (the old ones become f's next
+// buffer) and uploads. False if f keeps geometry the vertex buffer no longer holds.
+static bool dz_moving_commit(dz_source_data *d, dz_moving_frame *f)
+{
+	if (!f->built && d->moving_dirty)
+		return false;
+
+	if (f->built) {
+		std::swap(d->batch.points, f->batch.points);
+		std::swap(d->batch.colors, f->batch.colors);
+		d->batch.lines_first = f->batch.lines_first;
+		d->batch.lines_count = f->batch.lines_count;
+		dz_batch_upload(&d->batch);
+
+		d->drawn_revision = f->revision;
+		d->drawn_us = f->t_now;
+		d->drawn_idle = f->idle;
+		d->drawn_gpu = f->gpu;
+		d->moving_dirty = false;
+	}
+	if (f->events_filled && !dz_upload_gpu_events(d, f))
+		d->events_dirty = true;
 
-	const float rowH = dz_base_row_height(d);
-	return topPad + bottomPad + visible_rows * rowH + rowGap * (visible_rows - 1);
+	// Its input is on screen with this render: latency is taken when the render ends
+	d->perf.drained_us.insert(d->perf.drained_us.end(), f->drained_us.begin(), f->drained_us.end());
+	f->drained_us.clear();
+	return true;
 }
 
-// Keep only last 30s like movv.html
-static void dz_cleanup_history(dz_source_data *d, int64_t t_now_ms)
+// Key segments and clicks: one full-source quad through dz-timeline.effect, reading the
+// event texture as of the last upload
+static void dz_draw_gpu_timeline(dz_source_data *d, const dz_layout &L, int64_t tNow)
 {
-	const int64_t keep_after = t_now_ms - 30000;
+	const uint32_t cx = d->cfg->width;
+	const uint32_t cy = (uint32_t)std::ceil(std::max(1.0f, L.H));
+	vec2 size;
+	vec2_set(&size, (float)cx, (float)cy);
+	vec4 window;
+	vec4_set(&window, (float)(tNow - d->cfg->window_us - d->events_base_us), (float)(tNow - d->events_base_us),
+		 L.timelineX0, L.timelineW);
+	vec4 extent;
+	vec4_set(&extent, L.timelineX1, (float)L.visible_rows, 0.0f, 0.0f);
+
+	gs_effect_set_texture(d->timeline_image, d->timeline_events);
+	gs_effect_set_vec2(d->timeline_size, &size);
+	gs_effect_set_vec4(d->timeline_window, &window);
+	gs_effect_set_vec4(d->timeline_extent, &extent);
+	while (gs_effect_loop(d->timeline_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, cx, cy);
+	}
+}
 
-	while (!d->clicks.empty() && d->clicks.front().time_ms < keep_after)
-		d->clicks.pop_front();
+// ------------------------------------------------------------
+// Builder thread: prepares the next frame's moving layer while the graphics thread
+// renders everything else. The render thread hands a source's prepared frame over at the
+// end of a render and waits for it at the start of the next, and touches neither that
+// source's timeline nor its settings snapshot in between.
+static void dz_builder_main(dz_builder *b)
+{
+	os_set_thread_name("dz-input-analyzer: builder");
+
+	std::unique_lock<std::mutex> guard(b->lock);
+	for (;;) {
+		b->cv.wait(guard, [b] { return !b->queue.empty() || b->quit; });
+		if (b->queue.empty())
+			return;
+
+		dz_source_data *d = b->queue.front();
+		b->queue.erase(b->queue.begin());
+		guard.unlock();
+		dz_moving_build(d, &d->moving);
+		guard.lock();
+		d->build_busy = false;
+		b->cv.notify_all();
+	}
+}
 
-	while (!d->segments.empty()) {
-		auto &s0 = d->segments.front();
-		const int64_t end0 = (s0.end_ms < 0) ? t_now_ms : s0.end_ms;
-		if (end0 >= keep_after)
-			break;
-		d->segments.pop_front();
+static void dz_builder_kick(dz_source_data *d)
+{
+	dz_builder *b = &g_builder;
+	{
+		std::lock_guard<std::mutex> guard(b->lock);
+		d->build_busy = true;
+		b->queue.push_back(d);
 	}
+	b->cv.notify_all();
+	d->moving_queued = true;
 }
 
-static void dz_source_render(void *data, gs_effect_t *effect)
+// Returns true if a frame was handed over since the last wait; it is complete now
+static bool dz_builder_wait(dz_source_data *d)
 {
-	UNUSED_PARAMETER(effect);
+	if (!d->moving_queued)
+		return false;
+	d->moving_queued = false;
 
-	auto *d = (dz_source_data *)data;
-	if (!d || !d->solid)
-		return;
+	dz_builder *b = &g_builder;
+	std::unique_lock<std::mutex> guard(b->lock);
+	b->cv.wait(guard, [d] { return !d->build_busy; });
+	return true;
+}
 
-	d->frame_counter++;
+static void dz_builder_enable(dz_source_data *d, bool enable)
+{
+	if (enable == d->async_build)
+		return;
 
-	const float W = (float)d->width;
-	const float H = dz_visible_height(d);
+	dz_builder *b = &g_builder;
+	if (!enable)
+		dz_builder_wait(d);
+	d->async_build = enable;
+
+	std::lock_guard<std::mutex> users(b->users_lock);
+	if (enable) {
+		if (b->users++ == 0) {
+			b->quit = false;
+			b->queue.reserve(16);
+			b->thread = std::thread(dz_builder_main, b);
+		}
+		return;
+	}
+	if (--b->users > 0)
+		return;
 
-	gs_effect_t *solid = d->solid;
+	{
+		std::lock_guard<std::mutex> guard(b->lock);
+		b->quit = true;
+	}
+	b->cv.notify_all();
+	b->thread.join();
+}
 
+// Later views of a frame: the static layer, the shader timeline with the texture and time
+// the first view used, and the vertex buffer it uploaded
+static void dz_present_cached(dz_source_data *d)
+{
 	gs_reset_blend_state();
 	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
 
-	// IMPORTANT:
-	// Do not override viewport/projection here.
-	// Let OBS handle all transforms (move/scale/rotate) so the drawn content
-	// stays locked to the Source Bounding Box.
-
-	// Background (simple tint)
-	vec4 bg = dz_col_from_obs_bgr(d->bg_color, d->bg_alpha);
-	dz_draw_rect(solid, 0.0f, 0.0f, W, H, bg);
+	dz_draw_static_layer(d);
+	if (d->frame_gpu_quad)
+		dz_draw_gpu_timeline(d, d->layout, d->frame_t_now);
+	dz_batch_submit(&d->batch, d->solid, d->solid_color);
+}
 
-	// Layout copied from movv.html draw()
-	const float leftPad = 70.0f * 1.3f;
-	const float rightPad = 20.0f;
-	const float topPad = 18.0f;
-	const float bottomPad = 55.0f;
+static void dz_source_render(void *data, gs_effect_t *effect)
+{
+	UNUSED_PARAMETER(effect);
 
-	const float timelineX0 = leftPad;
-	const float timelineX1 = W - rightPad;
-	const float timelineW = timelineX1 - timelineX0;
+	auto *d = (dz_source_data *)data;
+	if (!d || !d->solid)
+		return;
 
-	const float rowGap = 20.0f;
-	int visible_rows = 0;
-	for (int i = 0; i < ROW_COUNT; i++) {
-		if (d->row_enabled[i])
-			visible_rows++;
+	// Scenes, projectors and the Studio Mode preview each render the source once per frame.
+	// Only the first render of a video frame takes in input, settings and time; the others
+	// present the same cached layers, so every view shows the same frame.
+	const int64_t t_frame = dz_frame_time_us();
+	if (t_frame == d->frame_time_us) {
+		dz_present_cached(d);
+		return;
 	}
+	d->frame_time_us = t_frame;
+	d->frame_counter++;
 
-	const float rowH = dz_base_row_height(d);
+	const bool timed = dz_perf_enabled(d->cfg);
+	const uint64_t start_ns = timed ? os_gettime_ns() : 0;
 
-	float rowYs[ROW_COUNT];
-	for (int i = 0; i < ROW_COUNT; i++)
-		rowYs[i] = -1.0f;
+	// The builder is done with the timeline and snapshot before anything changes them
+	const bool prebuilt = dz_builder_wait(d);
 
-	if (visible_rows > 0) {
-		int row_index = 0;
-		for (int i = 0; i < ROW_COUNT; i++) {
-			if (!d->row_enabled[i])
-				continue;
-			rowYs[i] = topPad + row_index * (rowH + rowGap);
-			row_index++;
-		}
+	// New settings: first pull what the input hub published under the old bindings
+	if (dz_source_settings *next = d->pending.exchange(nullptr, std::memory_order_acq_rel)) {
+		dz_drain_events(d);
+		dz_adopt_settings(d, next, t_frame);
 	}
 
-	// Time window (moving)
-	const int64_t tNow = now_ms();
-	const int64_t WINDOW_MS = 5000;
-	const int64_t t0 = tNow - WINDOW_MS;
-	const int64_t t1 = tNow;
-
-	auto xOf = [&](int64_t t) -> float {
-		const double denom = (double)(t1 - t0);
-		if (denom <= 0.0)
-			return timelineX0;
-		const double u = (double)(t - t0) / denom;
-		return timelineX0 + (float)(u * (double)timelineW);
-	};
-
-	auto clampf = [&](float v, float a, float b) -> float {
-		return std::max(a, std::min(b, v));
-	};
-
-	// Grid vertical lines at 0..5s
-	vec4 grid = dz_col_rgba(0.160784f, 0.160784f, 0.160784f, 1.0f); // #292929
-	const float axisY = H - bottomPad + 22.0f;
-	const float axisY2 = axisY + 2.0f; // baseline thickness
-	for (int i = 0; i <= 5; i++) {
-		const float x = timelineX0 + ((float)i * 1000.0f / (float)WINDOW_MS) * timelineW;
-		const float y0 = topPad - 6.0f;
-		const float h = std::max(2.0f, axisY2 - y0);
-		dz_draw_rect(solid, x, y0, 2.0f, h, grid);
-	}
-
-	
-	// Row labels using bitmap font
-	if (visible_rows > 0) {
-		vec4 text = dz_col_rgba(1.0f, 1.0f, 1.0f, 0.92f);
-		for (int i = 0; i < ROW_COUNT; i++) {
-			if (!d->row_enabled[i])
-				continue;
-			const std::string label_value = dz_key_label(d->row_key_vkey[i]);
-			const char *label = label_value.c_str();
-			const size_t label_len = label_value.size();
-			float scale = 4.0f * 0.85f;
-			if (label_len > 10)
-				scale = 3.0f * 0.85f;
-			if (label_len > 16)
-				scale = 2.0f * 0.85f;
-			const float yMid = rowYs[i] + rowH * 0.5f;
-			// Center the 5x7 block vertically around yMid
-			const float glyphH = 7.0f * std::floor(scale);
-			const float y = yMid - glyphH * 0.5f;
-			dz_draw_text_5x7(solid, 22.0f, y, label, scale, text);
-		}
+	// Live: the frame time on the capture clock. Replay: the session clock, after feeding
+	// the file up to it. Input stamped after the frame time shows up with the next frame.
+	int64_t tNow = t_frame;
+	if (const dz_replay_file *f = d->cfg->replay_file) {
+		tNow = dz_replay_time(d, f, t_frame);
+		dz_replay_advance(d, f, tNow);
 	}
 
-	// Key segments (height 60% of rowH, sharp corners)
-	if (visible_rows > 0) {
-		for (const auto &seg : d->segments) {
-			if (!d->row_enabled[seg.row])
-				continue;
-		const int64_t end = (seg.end_ms < 0) ? tNow : seg.end_ms;
+	const dz_layout &L = d->layout;
 
-		if (end < t0 || seg.start_ms > t1)
-			continue;
+	// Rebuilt only when settings changed in dz_source_update
+	dz_update_static_layer(d, L);
 
-		float x0s = clampf(xOf(seg.start_ms), timelineX0, timelineX1);
-		float x1s = clampf(xOf(end), timelineX0, timelineX1);
+	gs_reset_blend_state();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
 
-		float w = std::max(2.0f, x1s - x0s);
-			float h = std::max(2.0f, std::round(rowH * 0.2975625f));
-		float y = rowYs[seg.row] + std::round((rowH - h) * 0.5f);
+	// IMPORTANT:
+	// Do not override viewport/projection here.
+	// Let OBS handle all transforms (move/scale/rotate) so the drawn content
+	// stays locked to the Source Bounding Box.
 
-			vec4 c = row_color(d, seg.row, 0.95f);
-			dz_draw_rect(solid, x0s, y, w, h, c);
-		}
+	// Background, grid, labels and axis: one textured quad
+	dz_draw_static_layer(d);
+
+	// Moving content. The builder's frame was made for this frame time from everything
+	// drained by the end of the last render; input that arrived since then shows with the
+	// next frame, as it would had this frame been rendered right then. If the time or
+	// settings moved differently, catch up on input and build it here instead.
+	dz_moving_frame *f = &d->moving;
+	const bool ready = prebuilt && f->cfg == d->cfg && f->t_now == tNow && dz_moving_commit(d, f);
+	if (!ready) {
+		dz_drain_events(d);
+
+		// Retention first: it can change the stats strip, and never drops anything visible
+		dz_timeline_cleanup(&d->timeline, d->cfg, tNow);
+		dz_moving_prepare(d, f, tNow);
+		dz_moving_build(d, f);
+		dz_moving_commit(d, f);
 	}
 
-	// Click markers + delta numbers
-	if (visible_rows > 0) {
-		for (const auto &c : d->clicks) {
-			if (!d->row_enabled[c.row])
-				continue;
-			if (c.time_ms < t0 || c.time_ms > t1)
-				continue;
-
-			const float x = xOf(c.time_ms);
-
-			// Color + height are driven by the last key pressed before the click (c.row).
-			// One variable controls both the click line and the delta number color.
-			vec4 clickCol = row_color(d, c.row, 0.90f);
-
-			// Click line: starts at the TOP of the row of the last key, ends at the baseline.
-			const float y0 = rowYs[c.row];
-			const float h = std::max(2.0f, axisY2 - y0);
-			dz_draw_rect(solid, x, y0, 2.0f, h, clickCol);
-
-			// Number near the row (same color as the click line)
-			const float scale = 3.0f;
-
-			char buf[16]{};
-			_snprintf_s(buf, _TRUNCATE, "%d", c.delta_ms);
-
-			const float yText = rowYs[c.row] - 6.0f;
-			dz_draw_text_5x7(solid, x + 6.0f, yText + 0.1f, buf, scale, clickCol);
-		}
+	// Key segments and clicks go first, under the lane, stats and overlay. While idle the
+	// shader has nothing to draw.
+	d->frame_t_now = tNow;
+	d->frame_gpu_quad = f->gpu && !f->idle && !d->events_dirty;
+	if (d->frame_gpu_quad)
+		dz_draw_gpu_timeline(d, L, tNow);
+	dz_batch_submit(&d->batch, d->solid, d->solid_color);
+
+	if (timed) {
+		d->perf.rects = (uint32_t)((d->batch.vb_count - d->batch.vb_lines_count) / 6);
+		d->perf.draws = (d->static_layer ? 1 : 0) + dz_batch_draws(&d->batch) + (d->frame_gpu_quad ? 1 : 0);
 	}
 
-	// TIME axis line + ticks + labels 0s..5s
-	{
-		const float axisY = H - bottomPad + 22.0f;
-
-		// Axis baseline: #292929
-		vec4 axis = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
-		dz_draw_rect(solid, timelineX0, axisY, timelineW, 2.0f, axis);
-
-		// Tick/grid color: #292929 (only the 6 vertical lines)
-		vec4 grid = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
-
-		// Tick label color (0s..5s)
-		vec4 tcol = dz_col_rgba(0.1608f, 0.1608f, 0.1608f, 1.0f);
-
-		for (int i = 0; i <= 5; i++) {
-			const float x = timelineX0 + ((float)i * 1000.0f / (float)WINDOW_MS) * timelineW;
-			dz_draw_rect(solid, x, axisY, 2.0f, 12.0f, grid);
-
-			char lab[4]{};
-			lab[0] = (char)('0' + i);
-			lab[1] = 'S';
-			lab[2] = 0;
-
-			dz_draw_text_5x7(solid, x - 10.0f, axisY + 10.0f, lab, 2.28f, tcol);
-		}
+	// Settings may have turned instrumentation on or off during this frame
+	if (timed && dz_perf_enabled(d->cfg))
+		dz_perf_end_frame(d, start_ns);
+
+	// Hand the next frame to the builder, timed for when OBS will render it and built from
+	// all input captured up to now, so the worker adds no frame of latency. A frame that
+	// would be the same as the uploaded one is left alone: idle sources never wake it.
+	if (d->async_build) {
+		const dz_replay_file *rf = d->cfg->replay_file;
+		const int64_t t_next = rf ? dz_replay_time(d, rf, dz_next_frame_time_us()) : dz_next_frame_time_us();
+		dz_drain_events(d);
+		if (rf)
+			dz_replay_advance(d, rf, t_next);
+		dz_timeline_cleanup(&d->timeline, d->cfg, t_next);
+		dz_moving_prepare(d, f, t_next);
+		if (f->built || f->events_filled)
+			dz_builder_kick(d);
 	}
 
-
-	// Cleanup history like movv.html (keep 30s)
-	dz_cleanup_history(d, tNow);
-
 	// OBS handles viewport/projection.
 }
 
@@ -1152,6 +2901,9 @@ static obs_source_info dz_source_info;
 
 bool obs_module_load(void)
 {
+	if (!dz_hub_start())
+		blog(LOG_WARNING, "[dz-input-analyzer] input hub failed to start, raw input disabled");
+
 	memset(&dz_source_info, 0, sizeof(dz_source_info));
 
 	dz_source_info.id = "dz_input_analyzer";
@@ -1174,6 +2926,12 @@ bool obs_module_load(void)
 	return true;
 }
 
+void obs_module_unload(void)
+{
+	dz_hub_stop();
+	blog(LOG_INFO, "[dz-input-analyzer] input hub stopped");
+}
+
 const char *obs_module_name(void)
 {
 	return "DZ Input Analyzer";
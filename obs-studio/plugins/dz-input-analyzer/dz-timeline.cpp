@@ -0,0 +1,507 @@
+// plugins/dz-input-analyzer/dz-timeline.cpp
+#include "dz-timeline.h"
+
+#include <cstdio>
+
+// ------------------------------------------------------------
+// Counter-strafe analytics
+static void dz_strafe_init(dz_strafe_stats *st)
+{
+	st->gap.set_range(-DZ_STRAFE_MAX_US, DZ_STRAFE_MAX_US);
+	st->shot.set_range(0, DZ_SHOT_MAX_US);
+}
+
+static void dz_strafe_reset(dz_strafe_stats *st)
+{
+	const uint32_t cap = st->gap.samples.capacity();
+	*st = dz_strafe_stats();
+	dz_strafe_init(st);
+	st->gap.resize(cap);
+	st->shot.resize(cap);
+}
+
+static void dz_strafe_stop(dz_strafe_stats *st, int64_t t, int64_t gap_us)
+{
+	st->gap.add(t, gap_us);
+	st->stop_us = t;
+	st->shot_armed = true;
+	st->label_dirty = true;
+}
+
+// Returns the stop this key event made: gap (> 0) or overlap (< 0), INT64_MIN if none
+static int64_t dz_strafe_key(dz_strafe_stats *st, int row, bool down, int64_t t)
+{
+	for (dz_strafe_axis &ax : st->axes) {
+		const int side = ax.row[0] == row ? 0 : ax.row[1] == row ? 1 : -1;
+		if (side < 0)
+			continue;
+		const int other = 1 - side;
+
+		int64_t stop = INT64_MIN;
+		if (down) {
+			// Counter key after the other one was released: a gap
+			if (!ax.down[other] && ax.release_us[other] >= 0 && t - ax.release_us[other] <= DZ_STRAFE_MAX_US)
+				stop = t - ax.release_us[other];
+			ax.down[side] = true;
+			ax.press_us[side] = t;
+		} else {
+			// Released while the counter key was already held: an overlap
+			if (ax.down[other] && ax.press_us[other] > ax.press_us[side] &&
+			    t - ax.press_us[other] <= DZ_STRAFE_MAX_US)
+				stop = -(t - ax.press_us[other]);
+			ax.down[side] = false;
+			ax.release_us[side] = t;
+		}
+		if (stop != INT64_MIN)
+			dz_strafe_stop(st, t, stop);
+		return stop;
+	}
+	return INT64_MIN;
+}
+
+// Returns the shot time this click measured from the last stop, -1 if none
+static int64_t dz_strafe_click(dz_strafe_stats *st, int64_t t)
+{
+	if (!st->shot_armed)
+		return -1;
+	st->shot_armed = false;
+	if (t - st->stop_us > DZ_SHOT_MAX_US)
+		return -1;
+	st->shot.add(t, t - st->stop_us);
+	st->label_dirty = true;
+	return t - st->stop_us;
+}
+
+// Only reformatted when a sample was added or expired
+const char *dz_strafe_label(dz_strafe_stats *st)
+{
+	if (!st->label_dirty)
+		return st->label;
+	st->label_dirty = false;
+
+	if (st->gap.samples.empty()) {
+		snprintf(st->label, sizeof(st->label), "NO COUNTER STRAFES");
+		return st->label;
+	}
+
+	const dz_stat &g = st->gap;
+	const dz_stat &k = st->shot;
+	snprintf(st->label, sizeof(st->label),
+		 "GAP AVG %.1f P50 %.0f P99 %.0f   SHOT AVG %.0f P50 %.0f P99 %.0f   N %u", g.mean_ms(),
+		 g.percentile_ms(0.5), g.percentile_ms(0.99), k.mean_ms(), k.percentile_ms(0.5), k.percentile_ms(0.99),
+		 g.samples.size());
+	return st->label;
+}
+
+// ------------------------------------------------------------
+// Timeline (render thread)
+static void dz_motion_push(dz_motion_lane *lane, int64_t t, uint32_t speed)
+{
+	lane->fine.push_back({t, speed, speed, 1});
+
+	const int64_t bucket = t - t % DZ_MOTION_COARSE_US;
+	if (!lane->coarse.empty() && lane->coarse.back().time_us == bucket) {
+		dz_motion_bin &b = lane->coarse.back();
+		b.lo = std::min(b.lo, speed);
+		b.hi = std::max(b.hi, speed);
+		b.count++;
+	} else {
+		lane->coarse.push_back({bucket, speed, speed, 1});
+	}
+}
+
+static void dz_format_delta(char (&buf)[12], int64_t delta_us, bool sub_ms)
+{
+	if (sub_ms)
+		snprintf(buf, sizeof(buf), "%.1f", (double)delta_us / 1000.0);
+	else
+		snprintf(buf, sizeof(buf), "%lld", (long long)std::clamp<int64_t>(delta_us / 1000, 0, 99999999));
+}
+
+static inline void dz_timeline_touch(dz_timeline *tl, int64_t t)
+{
+	tl->revision++;
+	tl->last_item_us = std::max(tl->last_item_us, t);
+}
+
+void dz_timeline_init(dz_timeline *tl)
+{
+	dz_strafe_init(&tl->strafe);
+}
+
+// Applies one event to the private timeline; out, if given, receives what it measured
+void dz_timeline_apply(dz_timeline *tl, const dz_settings *s, const dz_input_event &ev, dz_applied *out)
+{
+	const int64_t t = ev.time_us;
+	dz_applied applied;
+
+	switch (ev.type) {
+	case DZ_EVENT_CLICK: {
+		// movv.html: left click creates marker and delta from last keydown
+		int row = std::min<int>(ROW_D, s->row_count - 1);
+		int64_t delta = 0;
+
+		if (tl->last_key_valid) {
+			row = tl->last_key_row;
+			const int64_t raw_delta = t - tl->last_key_down_us;
+			delta = (raw_delta > 0) ? raw_delta : 0;
+		}
+
+		dz_click_event c;
+		c.time_us = t;
+		c.delta_us = delta;
+		dz_format_delta(c.label, delta, s->show_sub_ms);
+		tl->rows[row].clicks.push_back(c);
+		applied.row = row;
+		applied.value_us = delta;
+		applied.shot_us = dz_strafe_click(&tl->strafe, t);
+		dz_timeline_touch(tl, t);
+		break;
+	}
+	case DZ_EVENT_KEY_DOWN: {
+		const int row = vkey_to_row(s, ev.vkey);
+		if (row == -1)
+			break;
+
+		// Start a segment only if there is no open one for this row.
+		const uint32_t bit = 1u << row;
+		if (!(tl->open_rows & bit)) {
+			tl->rows[row].segments.push_back({t, -1});
+			tl->open_rows |= bit;
+			applied.row = row;
+			applied.strafe_us = dz_strafe_key(&tl->strafe, row, true, t);
+			tl->last_key_row = row;
+			tl->last_key_down_us = t;
+			tl->last_key_valid = true;
+			dz_timeline_touch(tl, t);
+		}
+		break;
+	}
+	case DZ_EVENT_MOTION:
+		if (tl->motion.capacity) {
+			dz_motion_push(&tl->motion, t, ev.value);
+			dz_timeline_touch(tl, t);
+		}
+		break;
+	case DZ_EVENT_KEY_UP: {
+		const int row = vkey_to_row(s, ev.vkey);
+		if (row == -1)
+			break;
+
+		// keyup: close the open segment for this row
+		const uint32_t bit = 1u << row;
+		if (tl->open_rows & bit) {
+			dz_key_segment &seg = tl->rows[row].segments.back();
+			seg.end_us = t;
+			tl->open_rows &= ~bit;
+			applied.row = row;
+			applied.value_us = t - seg.start_us;
+			applied.strafe_us = dz_strafe_key(&tl->strafe, row, false, t);
+			dz_timeline_touch(tl, t);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (out)
+		*out = applied;
+}
+
+// Resizes the rings only when the retention setting changed, never in steady state
+static void dz_apply_history_capacity(dz_timeline *tl, const dz_settings *s)
+{
+	const uint32_t cap = s->history_capacity;
+	const int rows = s->row_count;
+	if (cap == 0 || (cap == tl->capacity && rows == tl->sized_rows))
+		return;
+
+	for (int i = 0; i < DZ_MAX_ROWS; i++) {
+		const uint32_t row_cap = i < rows ? cap : DZ_IDLE_ROW_CAPACITY;
+		tl->rows[i].segments.resize(row_cap);
+		tl->rows[i].clicks.resize(row_cap);
+	}
+	tl->strafe.gap.resize(cap);
+	tl->strafe.shot.resize(cap);
+	tl->strafe.label_dirty = true;
+	tl->capacity = cap;
+	tl->sized_rows = rows;
+}
+
+static void dz_apply_motion_lane(dz_timeline *tl, const dz_settings *s)
+{
+	const uint32_t cap = s->show_motion ? dz_motion_capacity(s->window_us) : 0;
+	if (cap == tl->motion.capacity)
+		return;
+
+	if (cap) {
+		tl->motion.fine.resize(cap);
+		tl->motion.coarse.resize(std::max<uint32_t>(64, cap / 16));
+	} else {
+		tl->motion.fine = {};
+		tl->motion.coarse = {};
+	}
+	tl->motion.capacity = cap;
+}
+
+// Drops all timeline state, keeping the allocated capacity
+void dz_timeline_reset(dz_timeline *tl)
+{
+	for (dz_row_timeline &row : tl->rows) {
+		row.segments.reset(row.segments.capacity());
+		row.clicks.reset(row.clicks.capacity());
+	}
+	tl->open_rows = 0;
+	tl->last_key_valid = false;
+	tl->last_item_us = INT64_MIN;
+	tl->revision++;
+	if (tl->motion.capacity) {
+		tl->motion.fine.reset(tl->motion.fine.capacity());
+		tl->motion.coarse.reset(tl->motion.coarse.capacity());
+	}
+	dz_strafe_reset(&tl->strafe);
+}
+
+// Moves the timeline from prev (null for the first snapshot) to next
+void dz_timeline_adopt(dz_timeline *tl, const dz_settings *prev, const dz_settings *next, int64_t t_now_us)
+{
+	// A rebound or removed row would never see the key-up of its old key: close it now
+	if (prev) {
+		for (int i = 0; i < DZ_MAX_ROWS; i++) {
+			const uint32_t bit = 1u << i;
+			if (!(tl->open_rows & bit))
+				continue;
+			if (i < next->row_count && prev->row_key_vkey[i] == next->row_key_vkey[i])
+				continue;
+			dz_key_segment &seg = tl->rows[i].segments.back();
+			seg.end_us = std::max(t_now_us, seg.start_us);
+			tl->open_rows &= ~bit;
+			dz_strafe_key(&tl->strafe, i, false, seg.end_us);
+			dz_timeline_touch(tl, seg.end_us);
+		}
+		if (tl->last_key_row >= next->row_count)
+			tl->last_key_valid = false;
+	}
+
+	dz_apply_history_capacity(tl, next);
+	dz_apply_motion_lane(tl, next);
+	tl->revision++;
+
+	// Toggling sub-ms display re-labels the stored clicks once
+	if (tl->click_labels_sub_ms != next->show_sub_ms) {
+		tl->click_labels_sub_ms = next->show_sub_ms;
+		for (dz_row_timeline &row : tl->rows) {
+			for (uint32_t i = 0; i < row.clicks.size(); i++)
+				dz_format_delta(row.clicks[i].label, row.clicks[i].delta_us, tl->click_labels_sub_ms);
+		}
+	}
+}
+
+// Keep only the configured retention (30s by default, like movv.html)
+void dz_timeline_cleanup(dz_timeline *tl, const dz_settings *s, int64_t t_now_us)
+{
+	const int64_t keep_after = t_now_us - s->history_us;
+
+	for (int i = 0; i < s->row_count; i++) {
+		dz_row_timeline &row = tl->rows[i];
+		while (!row.clicks.empty() && row.clicks.front().time_us < keep_after)
+			row.clicks.pop_front();
+
+		// An open segment ends at t_now, so it is never popped
+		while (!row.segments.empty()) {
+			const dz_key_segment &s0 = row.segments.front();
+			const int64_t end0 = (s0.end_us < 0) ? t_now_us : s0.end_us;
+			if (end0 >= keep_after)
+				break;
+			row.segments.pop_front();
+		}
+	}
+
+	// Expiring samples changes the stats strip even when nothing is on screen
+	if (tl->strafe.gap.expire(keep_after) | tl->strafe.shot.expire(keep_after)) {
+		tl->strafe.label_dirty = true;
+		tl->revision++;
+	}
+
+	// The mouse lane only ever shows the display window
+	const int64_t lane_after = t_now_us - s->window_us - DZ_MOTION_COARSE_US;
+	while (!tl->motion.fine.empty() && tl->motion.fine.front().time_us < lane_after)
+		tl->motion.fine.pop_front();
+	while (!tl->motion.coarse.empty() && tl->motion.coarse.front().time_us < lane_after)
+		tl->motion.coarse.pop_front();
+}
+
+// ------------------------------------------------------------
+// Capture (capture thread)
+
+// Publishes the finished motion bin. The hub timer flushes the last bin of a movement
+// once its millisecond is over; renderers read missing bins as zero speed. A bin reopened
+// after a key or click in the same millisecond goes out at that event's time, not before it.
+void dz_capture_flush_motion(dz_capture *cap)
+{
+	if (cap->motion_bin_us < 0)
+		return;
+
+	dz_input_event ev;
+	ev.time_us = std::max(cap->motion_bin_us, cap->last_publish_us);
+	ev.type = DZ_EVENT_MOTION;
+	const double dx = (double)cap->motion_dx;
+	const double dy = (double)cap->motion_dy;
+	ev.value = (uint32_t)std::lround(std::sqrt(dx * dx + dy * dy));
+
+	for (dz_subscriber *sub : cap->subscribers) {
+		if (sub->wants_motion.load(std::memory_order_relaxed))
+			dz_publish_event(sub, ev);
+	}
+
+	cap->motion_bin_us = -1;
+	cap->motion_dx = 0;
+	cap->motion_dy = 0;
+}
+
+// Key and click events flush the open motion bin first, so every subscriber sees
+// one time-ordered stream (the recorder relies on it).
+void dz_capture_publish(dz_capture *cap, const dz_input_event &ev)
+{
+	dz_capture_flush_motion(cap);
+	cap->last_publish_us = std::max(cap->last_publish_us, ev.time_us);
+	for (dz_subscriber *sub : cap->subscribers)
+		dz_publish_event(sub, ev);
+}
+
+void dz_capture_motion(dz_capture *cap, int64_t t, int dx, int dy)
+{
+	const int64_t bin = t - t % DZ_MOTION_BIN_US;
+	if (bin != cap->motion_bin_us) {
+		dz_capture_flush_motion(cap);
+		cap->motion_bin_us = bin;
+	}
+	cap->motion_dx += dx;
+	cap->motion_dy += dy;
+}
+
+void dz_capture_click(dz_capture *cap, int64_t t)
+{
+	dz_input_event ev;
+	ev.time_us = t;
+	ev.type = DZ_EVENT_CLICK;
+	dz_capture_publish(cap, ev);
+}
+
+// Key edge to the subscribers on one side: raw (no debounce on the key) or debounced
+static void dz_capture_publish_key(dz_capture *cap, const dz_input_event &ev, bool raw)
+{
+	dz_capture_flush_motion(cap);
+	cap->last_publish_us = std::max(cap->last_publish_us, ev.time_us);
+	for (dz_subscriber *sub : cap->subscribers) {
+		if ((sub->debounce_ms[ev.vkey].load(std::memory_order_relaxed) == 0) == raw)
+			dz_publish_event(sub, ev);
+	}
+}
+
+// Widest window any subscriber asked for on this key
+static int64_t dz_debounce_us(const dz_capture *cap, uint16_t vkey)
+{
+	uint32_t ms = 0;
+	for (const dz_subscriber *sub : cap->subscribers)
+		ms = std::max<uint32_t>(ms, sub->debounce_ms[vkey].load(std::memory_order_relaxed));
+	return (int64_t)ms * 1000;
+}
+
+static dz_input_event dz_key_event(uint16_t vkey, bool down, int64_t t)
+{
+	dz_input_event ev;
+	ev.time_us = t;
+	ev.type = down ? DZ_EVENT_KEY_DOWN : DZ_EVENT_KEY_UP;
+	ev.vkey = vkey;
+	return ev;
+}
+
+static void dz_publish_key(dz_capture *cap, uint16_t vkey, bool down, int64_t t)
+{
+	dz_set_key_bit(cap->key_down, vkey, down);
+	cap->key_edge_us[vkey] = t;
+	dz_capture_publish_key(cap, dz_key_event(vkey, down, t), false);
+}
+
+// Publishes a held-back edge once its window has closed, if the key did not bounce back.
+// It keeps its own time unless something later went out meanwhile.
+static void dz_settle_key(dz_capture *cap, uint16_t vkey, int64_t t, int64_t window_us)
+{
+	if (t - cap->key_edge_us[vkey] < window_us)
+		return;
+
+	dz_set_key_bit(cap->key_settling, vkey, false);
+	const bool raw = dz_key_bit(cap->key_raw, vkey);
+	if (raw != dz_key_bit(cap->key_down, vkey))
+		dz_publish_key(cap, vkey, raw, std::max(cap->key_raw_us[vkey], cap->last_publish_us));
+}
+
+// Sources map keys to rows themselves; only real transitions are published. Keydown repeats
+// while pressed never change the key's bit, and chatter inside the debounce window is
+// dropped before it reaches the queues of the subscribers that asked for the window.
+void dz_capture_key(dz_capture *cap, uint16_t vkey, bool down, int64_t t)
+{
+	if (vkey >= 256)
+		return;
+
+	if (down != dz_key_bit(cap->key_pressed, vkey)) {
+		dz_set_key_bit(cap->key_pressed, vkey, down);
+		dz_capture_publish_key(cap, dz_key_event(vkey, down, t), true);
+	}
+
+	const int64_t window_us = dz_debounce_us(cap, vkey);
+	if (dz_key_bit(cap->key_settling, vkey))
+		dz_settle_key(cap, vkey, t, window_us);
+
+	if (dz_key_bit(cap->key_settling, vkey)) {
+		dz_set_key_bit(cap->key_raw, vkey, down);
+		cap->key_raw_us[vkey] = t;
+		return;
+	}
+	if (down == dz_key_bit(cap->key_down, vkey))
+		return;
+
+	if (window_us && t - cap->key_edge_us[vkey] < window_us) {
+		dz_set_key_bit(cap->key_settling, vkey, true);
+		dz_set_key_bit(cap->key_raw, vkey, down);
+		cap->key_raw_us[vkey] = t;
+		return;
+	}
+	dz_publish_key(cap, vkey, down, t);
+}
+
+// Closes the debounce windows that ran out by t; returns true while any key is still held back
+bool dz_capture_settle(dz_capture *cap, int64_t t)
+{
+	bool pending = false;
+	for (int w = 0; w < 4; w++) {
+		uint64_t bits = cap->key_settling[w];
+		while (bits) {
+			int b = 0;
+			while (!((bits >> b) & 1))
+				b++;
+			bits &= bits - 1;
+
+			const uint16_t vkey = (uint16_t)(w * 64 + b);
+			dz_settle_key(cap, vkey, t, dz_debounce_us(cap, vkey));
+		}
+		pending |= cap->key_settling[w] != 0;
+	}
+	return pending;
+}
+
+// UI thread: the subscriber's debounce table for the rows in s. Rows sharing a key get the
+// wider window.
+void dz_subscriber_set_debounce(dz_subscriber *sub, const dz_settings *s)
+{
+	uint8_t ms[256] = {};
+	for (int i = 0; i < s->row_count; i++) {
+		const uint16_t vkey = s->row_key_vkey[i];
+		if (vkey < 256)
+			ms[vkey] = std::max(ms[vkey], s->row_debounce_ms[i]);
+	}
+	for (int k = 0; k < 256; k++)
+		sub->debounce_ms[k].store(ms[k], std::memory_order_relaxed);
+}
@@ -0,0 +1,479 @@
+// plugins/dz-input-analyzer/dz-timeline.h
+//
+// Timeline model, event ingestion and retention. Shared by the plugin and the headless
+// benchmark, so nothing in here may depend on libobs or Win32.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+// ------------------------------------------------------------
+// Timeline model (matches movv.html logic)
+// Rows are configured at runtime (row_count); the first four keep their WASD roles
+enum dz_row : int { ROW_W = 0, ROW_S = 1, ROW_A = 2, ROW_D = 3 };
+
+static constexpr int DZ_MAX_ROWS = 16;
+static constexpr int DZ_DEFAULT_ROWS = 4;
+
+struct dz_key_segment {
+	int64_t start_us = 0; // absolute us
+	int64_t end_us = -1;  // -1 while pressed
+};
+
+struct dz_click_event {
+	int64_t time_us = 0;  // absolute us
+	int64_t delta_us = 0; // >= 0
+	char label[12] = {};  // delta as drawn, formatted once when recorded
+};
+
+// Fixed-capacity, time-ordered FIFO over storage allocated once.
+// Pushing into a full history overwrites the oldest item.
+template<typename T> struct dz_history {
+	std::vector<T> items;
+	uint32_t mask = 0;
+	uint32_t head = 0; // next write
+	uint32_t tail = 0; // oldest
+
+	void reset(uint32_t capacity) // power of two
+	{
+		items.assign(capacity, T{});
+		mask = capacity - 1;
+		head = tail = 0;
+	}
+
+	uint32_t size() const { return head - tail; }
+	uint32_t capacity() const { return (uint32_t)items.size(); }
+	bool empty() const { return head == tail; }
+
+	T &operator[](uint32_t i) { return items[(tail + i) & mask]; }
+	const T &operator[](uint32_t i) const { return items[(tail + i) & mask]; }
+	T &front() { return items[tail & mask]; }
+	T &back() { return items[(head - 1) & mask]; }
+
+	void push_back(const T &v)
+	{
+		if (size() == (uint32_t)items.size())
+			tail++;
+		items[head++ & mask] = v;
+	}
+
+	void pop_front() { tail++; }
+
+	// Storage of item i, and how many items from there on up to n are contiguous with it
+	const T *data(uint32_t i) const { return &items[(tail + i) & mask]; }
+	uint32_t contiguous(uint32_t i, uint32_t n) const
+	{
+		return std::min(n, (uint32_t)items.size() - ((tail + i) & mask));
+	}
+
+	// Reallocates, keeping the newest items that fit
+	void resize(uint32_t capacity)
+	{
+		dz_history<T> next;
+		next.reset(capacity);
+		const uint32_t n = size();
+		for (uint32_t i = n > capacity ? n - capacity : 0; i < n; i++)
+			next.push_back((*this)[i]);
+		*this = std::move(next);
+	}
+
+	// Index of the first item for which before(item) is false (items must be partitioned)
+	template<typename Pred> uint32_t partition_point(Pred before) const
+	{
+		uint32_t lo = 0;
+		uint32_t hi = size();
+		while (lo < hi) {
+			const uint32_t mid = lo + (hi - lo) / 2;
+			if (before((*this)[mid]))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+};
+
+// Storage is sized from the retention window: nobody sustains more than ~20 presses or
+// clicks per second, so 25/s per row bounds memory for any session length.
+static constexpr uint32_t DZ_MAX_EVENTS_PER_SEC = 25;
+static constexpr uint32_t DZ_MAX_HISTORY_CAPACITY = 1u << 15; // per row
+
+inline uint32_t dz_history_capacity(int64_t history_us)
+{
+	const uint64_t need = (uint64_t)(history_us / 1000000 + 1) * DZ_MAX_EVENTS_PER_SEC;
+	uint32_t cap = 64;
+	while (cap < need && cap < DZ_MAX_HISTORY_CAPACITY)
+		cap <<= 1;
+	return cap;
+}
+
+// Segments in a row never overlap, so both start and end times are ordered.
+// Clicks are stored in the row of the key they are measured against.
+struct dz_row_timeline {
+	dz_history<dz_key_segment> segments;
+	dz_history<dz_click_event> clicks;
+};
+
+// Capacity for rows beyond row_count: they never receive events
+static constexpr uint32_t DZ_IDLE_ROW_CAPACITY = 64;
+
+// Mouse motion, pre-binned by the hub into 1 ms bins and merged into coarse buckets
+// on arrival, so drawing a column never touches more than a few bins.
+static constexpr int64_t DZ_MOTION_BIN_US = 1000;
+static constexpr int64_t DZ_MOTION_COARSE_US = 16000;
+
+struct dz_motion_bin {
+	int64_t time_us = 0; // bin start
+	uint32_t lo = 0;     // min speed over the bin, counts per ms
+	uint32_t hi = 0;     // max speed over the bin
+	uint32_t count = 0;  // 1 ms bins merged into this one
+};
+
+struct dz_motion_lane {
+	dz_history<dz_motion_bin> fine;   // DZ_MOTION_BIN_US
+	dz_history<dz_motion_bin> coarse; // DZ_MOTION_COARSE_US
+	uint32_t capacity = 0;            // fine capacity, 0 while the lane is off
+};
+
+inline uint32_t dz_motion_capacity(int64_t window_us)
+{
+	const uint64_t need = (uint64_t)(window_us / DZ_MOTION_BIN_US) + 1000;
+	uint32_t cap = 64;
+	while (cap < need)
+		cap <<= 1;
+	return cap;
+}
+
+// Running statistics over the retention window: a time-ordered sample ring for expiry
+// plus a fixed-bucket histogram, so adding or expiring a sample is O(1) and
+// percentiles cost one walk over the buckets.
+static constexpr int DZ_STAT_BUCKETS = 512;
+
+struct dz_stat_sample {
+	int64_t time_us = 0;
+	int64_t value_us = 0;
+};
+
+struct dz_stat {
+	dz_history<dz_stat_sample> samples;
+	uint32_t buckets[DZ_STAT_BUCKETS] = {};
+	int64_t sum_us = 0;
+	int64_t lo_us = 0;     // value at the start of bucket 0
+	int64_t bucket_us = 0; // bucket width; values outside the range land in the edge buckets
+
+	// Spreads the buckets over lo..hi (inclusive), which should be every value add() can see
+	void set_range(int64_t lo, int64_t hi)
+	{
+		lo_us = lo;
+		bucket_us = (hi - lo + DZ_STAT_BUCKETS) / DZ_STAT_BUCKETS;
+	}
+
+	int bucket(int64_t value_us) const
+	{
+		return (int)std::clamp<int64_t>((value_us - lo_us) / bucket_us, 0, DZ_STAT_BUCKETS - 1);
+	}
+
+	void pop()
+	{
+		const dz_stat_sample &old = samples.front();
+		buckets[bucket(old.value_us)]--;
+		sum_us -= old.value_us;
+		samples.pop_front();
+	}
+
+	void add(int64_t time_us, int64_t value_us)
+	{
+		if (!samples.capacity())
+			return;
+		if (samples.size() == samples.capacity())
+			pop();
+		samples.push_back({time_us, value_us});
+		buckets[bucket(value_us)]++;
+		sum_us += value_us;
+	}
+
+	// Returns true if anything expired
+	bool expire(int64_t keep_after_us)
+	{
+		bool changed = false;
+		while (!samples.empty() && samples.front().time_us < keep_after_us) {
+			pop();
+			changed = true;
+		}
+		return changed;
+	}
+
+	void resize(uint32_t capacity)
+	{
+		samples.resize(capacity);
+		memset(buckets, 0, sizeof(buckets));
+		sum_us = 0;
+		for (uint32_t i = 0; i < samples.size(); i++) {
+			buckets[bucket(samples[i].value_us)]++;
+			sum_us += samples[i].value_us;
+		}
+	}
+
+	double mean_ms() const { return samples.empty() ? 0.0 : (double)sum_us / samples.size() / 1000.0; }
+
+	// Bucket midpoint of the p-th percentile (p in 0..1)
+	double percentile_ms(double p) const
+	{
+		const uint32_t n = samples.size();
+		if (!n)
+			return 0.0;
+		const uint32_t rank = std::max<uint32_t>(1, (uint32_t)std::ceil(p * n));
+		uint32_t acc = 0;
+		int b = 0;
+		for (; b < DZ_STAT_BUCKETS - 1; b++) {
+			acc += buckets[b];
+			if (acc >= rank)
+				break;
+		}
+		return (double)(lo_us + b * bucket_us + bucket_us / 2) / 1000.0;
+	}
+};
+
+// Counter-strafe tracking for the opposing pairs A/D and W/S.
+// gap: counter key press minus release of the key it counters; negative means both keys
+// were held (overlap). shot: first click after the strafe stopped, measured from the stop.
+static constexpr int64_t DZ_STRAFE_MAX_US = 200000; // longer gaps are just walking
+static constexpr int64_t DZ_SHOT_MAX_US = 1000000;  // later clicks are not tied to the stop
+
+struct dz_strafe_axis {
+	int row[2];
+	bool down[2] = {false, false};
+	int64_t press_us[2] = {0, 0};
+	int64_t release_us[2] = {-1, -1};
+};
+
+struct dz_strafe_stats {
+	dz_strafe_axis axes[2] = {{{ROW_A, ROW_D}}, {{ROW_W, ROW_S}}};
+	dz_stat gap;  // -DZ_STRAFE_MAX_US..+DZ_STRAFE_MAX_US, 782 us buckets
+	dz_stat shot; // 0..DZ_SHOT_MAX_US, 1954 us buckets
+	int64_t stop_us = 0;
+	bool shot_armed = false;
+	bool label_dirty = true;
+	char label[96] = {};
+};
+
+// Raw input event as published by the input hub
+enum dz_event_type : uint8_t {
+	DZ_EVENT_KEY_DOWN = 0,
+	DZ_EVENT_KEY_UP = 1,
+	DZ_EVENT_CLICK = 2,
+	DZ_EVENT_MOTION = 3,
+};
+
+struct dz_input_event {
+	int64_t time_us = 0; // absolute us, taken on the capture thread (motion: bin start)
+	uint8_t type = DZ_EVENT_KEY_DOWN;
+	uint16_t vkey = 0;   // key events only
+	uint32_t value = 0;  // motion: speed over the bin, counts per ms
+};
+
+// Fixed-capacity lock-free single-producer/single-consumer ring.
+// The producer only writes head, the consumer only writes tail; a full ring drops the new item.
+template<typename T, uint32_t N> struct dz_spsc_ring {
+	static_assert((N & (N - 1)) == 0, "ring capacity must be a power of two");
+
+	alignas(64) std::atomic<uint32_t> head{0};
+	alignas(64) std::atomic<uint32_t> tail{0};
+	alignas(64) T items[N];
+
+	bool push(const T &v)
+	{
+		const uint32_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) >= N)
+			return false;
+		items[h & (N - 1)] = v;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T &out)
+	{
+		const uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire))
+			return false;
+		out = items[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side only
+	uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed); }
+};
+
+static constexpr uint32_t DZ_EVENT_RING_SIZE = 4096;
+
+// One per source: the hub (capture thread) produces, the source's render thread consumes.
+struct dz_subscriber {
+	dz_spsc_ring<dz_input_event, DZ_EVENT_RING_SIZE> events;
+	std::atomic<uint32_t> dropped_events{0};
+	std::atomic<bool> wants_motion{false}; // set while the mouse lane is shown
+
+	// Debounce window per vkey this subscriber asks the capture stage for, ms (0 = off: raw edges)
+	std::atomic<uint8_t> debounce_ms[256] = {};
+};
+
+static inline void dz_publish_event(dz_subscriber *sub, const dz_input_event &ev)
+{
+	if (!sub->events.push(ev))
+		sub->dropped_events.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Settings snapshot. The plugin builds one on the UI thread and hands it to the render
+// thread, which never modifies it once published.
+struct dz_settings {
+	dz_settings() = default;
+	dz_settings(const dz_settings &) = delete;
+	dz_settings &operator=(const dz_settings &) = delete;
+
+	// Source size
+	uint32_t width = 1500;
+	uint32_t height = 520;
+
+	// Visual config
+	float bg_alpha = 0.55f;
+	bool show_sub_ms = false; // click deltas with 0.1 ms resolution
+	int64_t window_us = 5000000;   // visible time span
+	int64_t history_us = 30000000; // retention, >= window_us
+	uint32_t history_capacity = 0; // per-row ring capacity for history_us
+
+	// Rows, one array per attribute; only the first row_count entries are used
+	int row_count = DZ_DEFAULT_ROWS;
+	bool row_enabled[DZ_MAX_ROWS] = {};
+	uint16_t row_key_vkey[DZ_MAX_ROWS] = {};
+	uint8_t row_debounce_ms[DZ_MAX_ROWS] = {}; // chatter filter for the row's key, 0 = off
+	char row_label[DZ_MAX_ROWS][4] = {}; // from dz_key_label
+	int8_t vkey_row[256];                // vkey -> row or -1
+
+	// Enabled rows in drawing order, so per-frame loops skip hidden rows entirely
+	uint8_t visible_row[DZ_MAX_ROWS] = {};
+	int visible_count = 0;
+
+	// Counter-strafe summary strip in the bottom pad
+	bool show_stats = false;
+
+	// Instrumentation; nothing is measured while both are off
+	bool perf_overlay = false;
+	bool perf_log = false;
+
+	// Key segments and clicks drawn by dz-timeline.effect instead of as CPU geometry
+	bool gpu_timeline = true;
+
+	// Mouse velocity lane under the key rows
+	bool show_motion = false;
+	uint32_t motion_full_scale = 40; // counts per ms at the top of the lane
+
+	// Colors (OBS color picker gives BGR: 0x00BBGGRR)
+	uint32_t bg_color = 0x000000; // background RGB in OBS BGR encoding (default black)
+	uint32_t key_color[DZ_MAX_ROWS] = {};
+};
+
+static inline int vkey_to_row(const dz_settings *s, uint16_t vkey)
+{
+	return vkey < 256 ? s->vkey_row[vkey] : -1;
+}
+
+// Private timeline of one view (render thread only)
+struct dz_timeline {
+	dz_row_timeline rows[DZ_MAX_ROWS];
+	uint32_t open_rows = 0; // bit per row: rows[i].segments.back() is still pressed
+	uint32_t capacity = 0;  // history capacity the rows are sized for
+	int sized_rows = 0;     // row_count the rows are sized for
+
+	// Counter-strafe analytics, fed from the same events as the rows
+	dz_strafe_stats strafe;
+
+	// Mouse lane, 0 capacity while it is hidden
+	dz_motion_lane motion;
+
+	// Format the click labels were last built with
+	bool click_labels_sub_ms = false;
+
+	// movv.html behavior: store "last keydown" (row + time)
+	int last_key_row = ROW_D;
+	int64_t last_key_down_us = 0;
+	bool last_key_valid = false;
+
+	// Bumped on every change that can alter what is drawn apart from scrolling
+	uint32_t revision = 0;
+	// Latest time any stored segment end, click or motion bin is drawn at
+	int64_t last_item_us = INT64_MIN;
+};
+
+// True when nothing stored can fall inside the window ending at t_now: the moving layer
+// is then the same for every t_now until the revision changes.
+static inline bool dz_timeline_idle(const dz_timeline *tl, const dz_settings *s, int64_t t_now_us)
+{
+	return !tl->open_rows && tl->last_item_us < t_now_us - s->window_us;
+}
+
+static constexpr int DZ_MAX_DEBOUNCE_MS = 50;
+
+static inline bool dz_key_bit(const uint64_t (&map)[4], uint16_t vkey)
+{
+	return (map[vkey >> 6] >> (vkey & 63)) & 1;
+}
+
+static inline void dz_set_key_bit(uint64_t (&map)[4], uint16_t vkey, bool on)
+{
+	const uint64_t bit = 1ull << (vkey & 63);
+	map[vkey >> 6] = on ? (map[vkey >> 6] | bit) : (map[vkey >> 6] & ~bit);
+}
+
+// Turns raw records into the published event stream for every subscriber
+// (capture thread only)
+struct dz_capture {
+	std::vector<dz_subscriber *> subscribers;
+
+	// Key state machines, one bit per vkey; autorepeat never changes either. key_pressed
+	// follows the device and its edges go to subscribers with no debounce on the key
+	// (the recorder and telemetry among them), so what they keep does not depend on other
+	// sources' settings. key_down is what the others see: an edge inside the key's debounce
+	// window after the last one it published is held in key_raw until the window closes
+	// (dz_capture_settle).
+	uint64_t key_pressed[4] = {};
+	uint64_t key_down[4] = {};
+	uint64_t key_settling[4] = {}; // keys with an edge held back
+	uint64_t key_raw[4] = {};      // their latest raw state
+	int64_t key_edge_us[256] = {}; // last published transition
+	int64_t key_raw_us[256] = {};  // latest held-back edge
+	int64_t last_publish_us = 0;   // keeps settled edges in stream order
+
+	// Motion bin being accumulated
+	int64_t motion_bin_us = -1;
+	int64_t motion_dx = 0;
+	int64_t motion_dy = 0;
+};
+
+const char *dz_strafe_label(dz_strafe_stats *st);
+
+// What applying one event measured, for consumers outside the timeline (telemetry export)
+struct dz_applied {
+	int row = -1;                  // row the event landed on, -1 if it changed nothing
+	int64_t value_us = 0;          // click: delta from the last key press; key up: time held
+	int64_t strafe_us = INT64_MIN; // key: counter-strafe stop, gap (> 0) or overlap (< 0)
+	int64_t shot_us = -1;          // click: first shot after a stop, measured from it
+};
+
+void dz_timeline_init(dz_timeline *tl);
+void dz_timeline_apply(dz_timeline *tl, const dz_settings *s, const dz_input_event &ev, dz_applied *out);
+void dz_timeline_reset(dz_timeline *tl);
+void dz_timeline_adopt(dz_timeline *tl, const dz_settings *prev, const dz_settings *next, int64_t t_now_us);
+void dz_timeline_cleanup(dz_timeline *tl, const dz_settings *s, int64_t t_now_us);
+
+void dz_capture_flush_motion(dz_capture *cap);
+void dz_capture_publish(dz_capture *cap, const dz_input_event &ev);
+void dz_capture_motion(dz_capture *cap, int64_t t, int dx, int dy);
+void dz_capture_click(dz_capture *cap, int64_t t);
+void dz_capture_key(dz_capture *cap, uint16_t vkey, bool down, int64_t t);
+bool dz_capture_settle(dz_capture *cap, int64_t t);
+
+void dz_subscriber_set_debounce(dz_subscriber *sub, const dz_settings *s);